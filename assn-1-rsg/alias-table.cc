@@ -0,0 +1,53 @@
+/**
+ * File: alias-table.cc
+ * --------------------
+ * Provides the implementation of the AliasTable class.
+ */
+
+#include "alias-table.h"
+#include <math.h>
+
+/**
+ * Constructor: AliasTable
+ * -----------------------
+ * Vose's construction.  Each weight is scaled so the average is 1, and
+ * outcomes are split into those below 1 (small) and those at or above it
+ * (large).  Repeatedly, a small outcome's column is topped up with a
+ * large outcome, whose remaining weight shrinks by the amount donated and
+ * which may then become small itself.  Whatever is left over at the end
+ * is 1 up to rounding error and keeps its whole column.
+ */
+
+AliasTable::AliasTable(const vector<double>& weights) :
+  uniform(true), thresholds(weights.size(), kOne), aliases(weights.size())
+{
+  int n = weights.size();
+  double total = 0;
+  for (int i = 0; i < n; i++) {
+    aliases[i] = i;
+    if (weights[i] > 0) total += weights[i];
+    if (weights[i] != weights[0]) uniform = false;
+  }
+  if (uniform || total <= 0) {
+    uniform = true;
+    return;
+  }
+
+  vector<double> scaled(n);
+  vector<int> small, large;
+  for (int i = 0; i < n; i++) {
+    scaled[i] = weights[i] > 0 ? weights[i] * n / total : 0;
+    (scaled[i] < 1 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    int under = small.back(), over = large.back();
+    small.pop_back();
+    thresholds[under] = (uint32_t) llround(scaled[under] * kOne);
+    aliases[under] = over;
+    scaled[over] -= 1 - scaled[under];
+    if (scaled[over] < 1) {
+      large.pop_back();
+      small.push_back(over);
+    }
+  }
+}
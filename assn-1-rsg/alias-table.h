@@ -0,0 +1,91 @@
+#ifndef __alias_table__
+#define __alias_table__
+
+/**
+ * File: alias-table.h
+ * -------------------
+ * Defines the AliasTable class, which draws from a fixed discrete
+ * distribution in constant time using Walker's alias method.  The n
+ * outcomes are laid out in n columns of equal height.  Column i holds
+ * outcome i up to some threshold and outcome alias[i] above it, so one
+ * uniform column choice plus one biased coin flip selects an outcome
+ * with exactly the intended probability (to 31 bits of precision).
+ *
+ * An AliasTable built from equal weights remembers that it's uniform
+ * and draws exactly one getRandomInteger(0, n - 1), so an unweighted
+ * grammar consumes the same random numbers it always has.
+ */
+
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+class AliasTable {
+
+ public:
+
+  /**
+   * Constant: kOne
+   * --------------
+   * The threshold meaning "always keep the column's own outcome".  Coin
+   * flips are drawn from [0, kOne), which Lemire's method draws without
+   * ever rejecting since kOne divides 2^32.
+   */
+
+  static const uint32_t kOne = 1u << 31;
+
+  /**
+   * Constructors: AliasTable
+   * ------------------------
+   * Build the table for the specified weights, which needn't sum to
+   * anything in particular.  Negative weights count as zero, and if no
+   * weight is positive the distribution is uniform.  The default
+   * constructor builds an empty table, which mustn't be sampled.
+   */
+
+  AliasTable() : uniform(true) {}
+  AliasTable(const vector<double>& weights);
+
+  /**
+   * Method: sample
+   * --------------
+   * Returns an index in [0, size()) drawn with probability proportional
+   * to its weight.  The generator may be anything with a
+   * getRandomInteger(low, high) method.
+   */
+
+  template <class Generator>
+  int sample(Generator& random) const
+  {
+    int column = random.getRandomInteger(0, (int) thresholds.size() - 1);
+    if (uniform) return column;
+    return pick(column, random.getRandomInteger(0, kOne - 1));
+  }
+
+  /**
+   * Method: pick
+   * ------------
+   * Resolves a column choice and a coin flip in [0, kOne) to an index.
+   */
+
+  int pick(int column, uint32_t coin) const { return coin < thresholds[column] ? column : aliases[column]; }
+
+  /**
+   * Methods: size, isUniform, getThreshold, getAlias
+   * ------------------------------------------------
+   * Expose the table itself, so it can be copied into some other
+   * representation (the Grammar lays every rule's table out flat).
+   */
+
+  int size() const { return thresholds.size(); }
+  bool isUniform() const { return uniform; }
+  uint32_t getThreshold(int column) const { return thresholds[column]; }
+  int getAlias(int column) const { return aliases[column]; }
+
+ private:
+  bool uniform;
+  vector<uint32_t> thresholds;
+  vector<int> aliases;
+};
+
+#endif // ! __alias_table__
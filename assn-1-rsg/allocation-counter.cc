@@ -0,0 +1,70 @@
+/**
+ * File: allocation-counter.cc
+ * ---------------------------
+ * Provides the counting replacements for the global operator new and
+ * operator delete.  Only the plain and nothrow forms are replaced; the
+ * array, sized and nothrow-delete forms forward to these by default.
+ */
+
+#include "allocation-counter.h"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+using namespace std;
+
+static atomic<long long> numAllocations(0);
+static atomic<long long> numBytesAllocated(0);
+
+long long getNumAllocations()
+{
+  return numAllocations.load(memory_order_relaxed);
+}
+
+long long getNumBytesAllocated()
+{
+  return numBytesAllocated.load(memory_order_relaxed);
+}
+
+/**
+ * Function: allocate
+ * ------------------
+ * Counts the allocation and makes it, giving the new handler a chance to
+ * free some memory for as long as there is one, as operator new must.
+ *
+ * @return the memory, or NULL if there's none and no new handler.
+ */
+
+static void *allocate(size_t size)
+{
+  numAllocations.fetch_add(1, memory_order_relaxed);
+  numBytesAllocated.fetch_add(size, memory_order_relaxed);
+  if (size == 0) size = 1;
+  while (true) {
+    void *memory = malloc(size);
+    if (memory != NULL) return memory;
+    new_handler handler = get_new_handler();
+    if (handler == NULL) return NULL;
+    handler();
+  }
+}
+
+void *operator new(size_t size)
+{
+  void *memory = allocate(size);
+  if (memory == NULL) throw bad_alloc();
+  return memory;
+}
+
+void *operator new(size_t size, const nothrow_t&) noexcept
+{
+  try {
+    return allocate(size);
+  } catch (...) {
+    return NULL;
+  }
+}
+
+void operator delete(void *memory) noexcept
+{
+  free(memory);
+}
@@ -0,0 +1,29 @@
+#ifndef __allocation_counter__
+#define __allocation_counter__
+
+/**
+ * File: allocation-counter.h
+ * --------------------------
+ * Declares the allocation counters.  Linking allocation-counter.o into a
+ * program replaces the global operator new and operator delete with
+ * versions that count every allocation made through them (which includes
+ * every standard container) before handing it to malloc.  Counting is a
+ * single relaxed atomic increment, so it's cheap enough to leave on in
+ * production, and generating sentences in the steady state makes no
+ * allocations at all, so anything these counters see there is a regression.
+ *
+ * Reading the counters before and after some piece of work gives the
+ * number of allocations that work made, across all threads.
+ */
+
+/**
+ * Functions: getNumAllocations, getNumBytesAllocated
+ * --------------------------------------------------
+ * Return the number of allocations made through operator new since the
+ * program started, and the total number of bytes they requested.
+ */
+
+long long getNumAllocations();
+long long getNumBytesAllocated();
+
+#endif // ! __allocation_counter__
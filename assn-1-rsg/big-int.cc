@@ -0,0 +1,110 @@
+/**
+ * File: big-int.cc
+ * ----------------
+ * Provides the implementation of the BigInt class.  Every operation is
+ * schoolbook arithmetic on 32-bit limbs with 64-bit intermediates.
+ */
+
+#include "big-int.h"
+#include <algorithm>
+#include <cassert>
+
+BigInt& BigInt::operator=(uint64_t value)
+{
+  limbs.clear();
+  for (; value != 0; value >>= 32) limbs.push_back((uint32_t) value);
+  return *this;
+}
+
+BigInt& BigInt::operator+=(const BigInt& other)
+{
+  if (limbs.size() < other.limbs.size()) limbs.resize(other.limbs.size(), 0);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < limbs.size() && (carry != 0 || i < other.limbs.size()); i++) {
+    uint64_t sum = (uint64_t) limbs[i] + carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+    limbs[i] = (uint32_t) sum;
+    carry = sum >> 32;
+  }
+  if (carry != 0) limbs.push_back((uint32_t) carry);
+  return *this;
+}
+
+BigInt& BigInt::operator-=(const BigInt& other)
+{
+  assert(!(*this < other));
+  int64_t borrow = 0;
+  for (size_t i = 0; i < limbs.size() && (borrow != 0 || i < other.limbs.size()); i++) {
+    int64_t difference = (int64_t) limbs[i] - borrow - (i < other.limbs.size() ? other.limbs[i] : 0);
+    borrow = difference < 0;
+    limbs[i] = (uint32_t) (difference + (borrow << 32));
+  }
+  trim();
+  return *this;
+}
+
+/**
+ * Method: addProduct
+ * ------------------
+ * Each row of the schoolbook product is added in as it's formed, with the
+ * row's carry rippling up through this value's higher limbs.
+ */
+
+void BigInt::addProduct(const BigInt& a, const BigInt& b)
+{
+  if (a.isZero() || b.isZero()) return;
+  size_t needed = max(limbs.size(), a.limbs.size() + b.limbs.size()) + 1;
+  if (limbs.size() < needed) limbs.resize(needed, 0);
+  for (size_t i = 0; i < a.limbs.size(); i++) {
+    uint64_t carry = 0, multiplier = a.limbs[i];
+    size_t j = 0;
+    for (; j < b.limbs.size(); j++) {
+      uint64_t sum = limbs[i + j] + multiplier * b.limbs[j] + carry;
+      limbs[i + j] = (uint32_t) sum;
+      carry = sum >> 32;
+    }
+    for (size_t k = i + j; carry != 0; k++) {
+      uint64_t sum = (uint64_t) limbs[k] + carry;
+      limbs[k] = (uint32_t) sum;
+      carry = sum >> 32;
+    }
+  }
+  trim();
+}
+
+bool BigInt::operator<(const BigInt& other) const
+{
+  if (limbs.size() != other.limbs.size()) return limbs.size() < other.limbs.size();
+  for (size_t i = limbs.size(); i > 0; i--)
+    if (limbs[i - 1] != other.limbs[i - 1]) return limbs[i - 1] < other.limbs[i - 1];
+  return false;
+}
+
+/**
+ * Method: toString
+ * ----------------
+ * Peels off nine decimal digits at a time by dividing a copy of the
+ * limbs by 10^9.
+ */
+
+string BigInt::toString() const
+{
+  if (isZero()) return "0";
+  vector<uint32_t> quotient(limbs);
+  vector<uint32_t> groups;
+  while (!quotient.empty()) {
+    uint64_t remainder = 0;
+    for (size_t i = quotient.size(); i > 0; i--) {
+      uint64_t current = (remainder << 32) | quotient[i - 1];
+      quotient[i - 1] = (uint32_t) (current / 1000000000);
+      remainder = current % 1000000000;
+    }
+    while (!quotient.empty() && quotient.back() == 0) quotient.pop_back();
+    groups.push_back((uint32_t) remainder);
+  }
+  string digits = to_string(groups.back());
+  for (size_t i = groups.size() - 1; i > 0; i--) {
+    string group = to_string(groups[i - 1]);
+    digits += string(9 - group.size(), '0') + group;
+  }
+  return digits;
+}
@@ -0,0 +1,114 @@
+#ifndef __big_int__
+#define __big_int__
+
+/**
+ * File: big-int.h
+ * ---------------
+ * Defines the BigInt class, an arbitrary precision unsigned integer with
+ * just the operations needed to count derivations and sample among them:
+ * addition, subtraction, multiply-accumulate, comparison, decimal output,
+ * and drawing a uniformly random value below a bound.
+ *
+ * A BigInt is a little-endian vector of 32-bit limbs with no leading zero
+ * limbs, so zero has no limbs at all.  The limbs are only ever reallocated
+ * when a value outgrows every value the BigInt has held before, so a
+ * BigInt reused as scratch space stops allocating once it's warmed up.
+ */
+
+#include <stdint.h>
+#include <limits.h>
+#include <string>
+#include <vector>
+using namespace std;
+
+class BigInt {
+
+ public:
+
+  /**
+   * Constructor: BigInt
+   * -------------------
+   * Constructs a BigInt with the specified value, which is 0 by default.
+   */
+
+  BigInt(uint64_t value = 0) { *this = value; }
+  BigInt& operator=(uint64_t value);
+
+  /**
+   * Predicate: isZero
+   * -----------------
+   * Self-explanatory.
+   */
+
+  bool isZero() const { return limbs.empty(); }
+
+  /**
+   * Operators: +=, -=
+   * -----------------
+   * Add the specified value to this one, or subtract it, which is only
+   * allowed if it's no larger than this one.
+   */
+
+  BigInt& operator+=(const BigInt& other);
+  BigInt& operator-=(const BigInt& other);
+
+  /**
+   * Method: addProduct
+   * ------------------
+   * Adds a * b to this value without building the product separately.
+   * Neither a nor b may be this BigInt.
+   */
+
+  void addProduct(const BigInt& a, const BigInt& b);
+
+  /**
+   * Operators: <, ==
+   * ----------------
+   * Self-explanatory.
+   */
+
+  bool operator<(const BigInt& other) const;
+  bool operator==(const BigInt& other) const { return limbs == other.limbs; }
+
+  /**
+   * Method: toString
+   * ----------------
+   * Returns the value in decimal.
+   */
+
+  string toString() const;
+
+  /**
+   * Method: setRandomBelow
+   * ----------------------
+   * Sets this value to one drawn uniformly from [0, bound), which must be
+   * nonempty.  Random limbs are drawn with the top one masked down to
+   * bound's bit length, and the draw is rejected if it isn't below bound,
+   * which happens less than half the time.
+   *
+   * @param bound the exclusive upper bound, which mustn't be this BigInt.
+   * @param random any generator with getRandomInteger(low, high).
+   */
+
+  template <class Generator>
+  void setRandomBelow(const BigInt& bound, Generator& random)
+  {
+    uint32_t top = bound.limbs.back();
+    uint32_t mask = top;
+    for (int shift = 1; shift < 32; shift *= 2) mask |= mask >> shift;
+    do {
+      limbs.resize(bound.limbs.size());
+      for (size_t i = 0; i + 1 < limbs.size(); i++)
+        limbs[i] = (uint32_t) random.getRandomInteger(INT_MIN, INT_MAX);
+      limbs.back() = (uint32_t) random.getRandomInteger(INT_MIN, INT_MAX) & mask;
+      trim();
+    } while (!(*this < bound));
+  }
+
+ private:
+  vector<uint32_t> limbs;
+
+  void trim() { while (!limbs.empty() && limbs.back() == 0) limbs.pop_back(); }
+};
+
+#endif // ! __big_int__
@@ -34,6 +34,11 @@ Definition::Definition(ifstream& infile)
   }
   
   getline(infile, uselessText, '}');
+
+  vector<double> weights;
+  for (size_t i = 0; i < possibleExpansions.size(); i++)
+    weights.push_back(possibleExpansions[i].getWeight());
+  chooser = AliasTable(weights);
 }
 
 /**
@@ -42,12 +47,18 @@ Definition::Definition(ifstream& infile)
  * Returns a const reference to one of the
  * embedded Productions.  Relies on the
  * correct implementation of the RandomNumberGenerator
- * class, but is otherwise a no-brainer.
+ * class, but is otherwise a no-brainer.  The no-argument
+ * version shares a single generator among all callers,
+ * so it isn't safe to call from several threads at once.
  */
 
 const Production& Definition::getRandomProduction() const
 {
   static RandomGenerator random; 
-  int randomIndex = random.getRandomInteger(0, possibleExpansions.size() - 1);
-  return possibleExpansions[randomIndex];
+  return getRandomProduction(random);
+}
+
+const Production& Definition::getRandomProduction(RandomGenerator& random) const
+{
+  return possibleExpansions[chooser.sample(random)];
 }
@@ -7,15 +7,28 @@
  * Encapulates the data necessary to capture
  * the notion of a CFG Definition.  A Definition
  * is just a nonterminal paired with all of
- * it's possible expansions.
+ * it's possible expansions.  The Productions' weights
+ * are compiled into an AliasTable when the Definition
+ * is read, so a weighted choice takes constant time.
  */
 
 #include "production.h"
+#include "random.h"
+#include "alias-table.h"
 #include <vector>
 using namespace std;  
 
 class Definition {
   
+ public:
+  
+  /**
+   * Provides STL-like iterator access to the sequence of Productions
+   * making up a Definition, in the order they appear in the grammar file.
+   */
+  
+  typedef vector<Production>::const_iterator const_iterator;
+  
  public:
   
   /**
@@ -80,7 +93,8 @@ class Definition {
    * ---------------------------
    * Returns an immutable reference to one and
    * exactly one of the Definition's expansions.
-   * The Production is chosen at random.
+   * The Production is chosen at random, with
+   * probability proportional to its weight.
    *
    * @return an immutable reference to a randomly selected
    *         Production held by the Definition.  It is assumed
@@ -88,10 +102,44 @@ class Definition {
    */
   
   const Production& getRandomProduction() const;
+
+  /**
+   * Method: getRandomProduction
+   * ---------------------------
+   * Same as above, except that the choice is drawn from the specified
+   * RandomGenerator rather than from one shared by every Definition,
+   * so that each thread can supply its own.
+   *
+   * @param random the generator used to make the choice.
+   * @return an immutable reference to a randomly selected Production.
+   */
+
+  const Production& getRandomProduction(RandomGenerator& random) const;
+  
+  /**
+   * Iterators: begin, end
+   * ---------------------
+   * Return iterators to the first Production and just past the last one,
+   * so that the full set of expansions can be traversed (for instance,
+   * to compile the grammar into some other representation).
+   */
+  
+  const_iterator begin() const { return possibleExpansions.begin(); }
+  const_iterator end() const { return possibleExpansions.end(); }
+
+  /**
+   * Method: getAliasTable
+   * ---------------------
+   * Returns the table the random choices are drawn from, whose
+   * outcomes are the Productions' positions in the Definition.
+   */
+
+  const AliasTable& getAliasTable() const { return chooser; }
   
  private:
   string nonterminal;
   vector<Production> possibleExpansions;
+  AliasTable chooser;
 };
 
 #endif // ! __definition__
@@ -0,0 +1,393 @@
+/**
+ * File: expander.cc
+ * -----------------
+ * Provides the implementation of the Expander class.
+ */
+
+#include "expander.h"
+#include <limits.h>
+
+/**
+ * Convenience structs: UniformSampler, TargetedSampler
+ * ----------------------------------------------------
+ * The two sources of top down choices, behind the same three methods so
+ * that expandTopDown can be written once.  UniformSampler supplies the
+ * SentenceCounter with its working space, and TargetedSampler supplies
+ * the LengthTable with the target range.
+ */
+
+struct UniformSampler {
+  const SentenceCounter& counter;
+  BigInt& scratch;
+  BigInt& term;
+
+  template <class Generator>
+  int chooseLength(int nonterminal, Generator& random) const
+  { return counter.chooseLength(nonterminal, random, scratch); }
+
+  template <class Generator>
+  int chooseProduction(int nonterminal, int length, Generator& random) const
+  { return counter.chooseProduction(nonterminal, length, random, scratch); }
+
+  template <class Generator>
+  int chooseSplit(int production, int i, int length, Generator& random) const
+  { return counter.chooseSplit(production, i, length, random, scratch, term); }
+};
+
+struct TargetedSampler {
+  const LengthTable& table;
+  int minLength;
+  int maxLength;
+
+  template <class Generator>
+  int chooseLength(int nonterminal, Generator& random) const
+  { return table.chooseLength(nonterminal, minLength, maxLength, random); }
+
+  template <class Generator>
+  int chooseProduction(int nonterminal, int length, Generator& random) const
+  { return table.chooseProduction(nonterminal, length, random); }
+
+  template <class Generator>
+  int chooseSplit(int production, int i, int length, Generator& random) const
+  { return table.chooseSplit(production, i, length, random); }
+};
+
+/**
+ * Method: expand
+ * --------------
+ * The top frame always holds the leftmost production with symbols left
+ * to expand.  Each iteration takes that production's next symbol: terminals
+ * go straight to the output, and nonterminals push a frame for a randomly
+ * chosen production.  A frame is popped as soon as its last symbol has been
+ * taken, before that symbol is expanded, so right recursion (a rule
+ * whose last symbol is itself) runs in constant stack space.  Depth is
+ * carried in the frames rather than read off the stack's size, so a
+ * popped frame's last symbol is still counted one level below it.
+ * The loop is compiled eight times, with and without each of limits,
+ * fingerprints and profiling, so an Expander that needs none of them
+ * doesn't test for them on every symbol.
+ *
+ * A profiled expansion keeps each frame until its last symbol's expansion
+ * has finished too, so that the stack holds every expansion in progress
+ * and popping a frame marks the end of one.  That costs right recursion
+ * its constant stack space, but leaves the random choices alone.
+ */
+
+template <class Generator>
+void Expander::expand(int nonterminal, Generator& random, OutputBuffer& output)
+{
+  fingerprint = 0;
+  if (counter != NULL) {
+    UniformSampler sampler = { *counter, scratch, term };
+    expandTopDown(sampler, nonterminal, random, output);
+    return;
+  }
+  if (table != NULL) {
+    TargetedSampler sampler = { *table, minLength, maxLength };
+    expandTopDown(sampler, nonterminal, random, output);
+    return;
+  }
+  stack.clear();
+  if (analysis != NULL) committed = analysis->getMinTokens(nonterminal);
+  if (profile != NULL) {
+    profile->recordSentence();
+    profiledRoot = nonterminal;
+  }
+  int features = (analysis != NULL) | (fingerprinter != NULL) << 1 | (profile != NULL) << 2;
+  switch (features) {
+    case 0: expandFrom<false, false, false>(nonterminal, random, output); break;
+    case 1: expandFrom<true, false, false>(nonterminal, random, output); break;
+    case 2: expandFrom<false, true, false>(nonterminal, random, output); break;
+    case 3: expandFrom<true, true, false>(nonterminal, random, output); break;
+    case 4: expandFrom<false, false, true>(nonterminal, random, output); break;
+    case 5: expandFrom<true, false, true>(nonterminal, random, output); break;
+    case 6: expandFrom<false, true, true>(nonterminal, random, output); break;
+    default: expandFrom<true, true, true>(nonterminal, random, output); break;
+  }
+}
+
+template <bool kLimited, bool kHashed, bool kProfiled, class Generator>
+void Expander::expandFrom(int nonterminal, Generator& random, OutputBuffer& output)
+{
+  if (kProfiled) owners.clear();
+  appendSymbol<kLimited, kHashed, kProfiled>(nonterminal, 0, random, output);
+  while (!stack.empty()) {
+    Frame& top = stack.back();
+    if (kProfiled) {
+      if (--untilSample == 0) takeSample();
+      if (top.next == top.end) {
+        finishFrame();
+        continue;
+      }
+    }
+    int symbol = *top.next++;
+    int depth = top.depth + 1;
+    if (!kProfiled && top.next == top.end) stack.pop_back();
+    appendSymbol<kLimited, kHashed, kProfiled>(symbol, depth, random, output);
+  }
+}
+
+void Expander::setLimits(const GrammarAnalysis& analysis, int maxDepth, long long maxTokens)
+{
+  bool limited = maxDepth != INT_MAX || maxTokens != LLONG_MAX;
+  this->analysis = limited ? &analysis : NULL;
+  this->maxDepth = maxDepth;
+  this->maxTokens = maxTokens;
+}
+
+/**
+ * Method: limitProduction
+ * -----------------------
+ * Returns the production to expand the specified nonterminal with: the
+ * randomly chosen one if it stays within both limits, and the shortest
+ * one otherwise.  committed already includes the nonterminal's own
+ * minimum, so choosing a production adds only the difference between
+ * its minimum and that, and the shortest production adds nothing.  A
+ * production that can't terminate never fits.
+ */
+
+int Expander::limitProduction(int nonterminal, int production, int depth)
+{
+  int shortest = analysis->getShortestProduction(nonterminal);
+  if (depth >= maxDepth) return shortest;
+  long long minimum = analysis->getProductionMinTokens(production);
+  if (minimum == GrammarAnalysis::kUnbounded) return shortest;
+  long long added = minimum - analysis->getMinTokens(nonterminal);
+  if (committed > maxTokens - added) return shortest;
+  committed += added;
+  return production;
+}
+
+/**
+ * Method: appendSymbol
+ * --------------------
+ * Appends a terminal (or an undefined nonterminal's name) to the output,
+ * or pushes a frame for a random production of a defined nonterminal.
+ * Empty productions are never pushed, since there's nothing in them to take.
+ * With limits, the random choice is drawn before they're consulted, and
+ * then overridden if it doesn't fit.
+ */
+
+template <bool kLimited, bool kHashed, bool kProfiled, class Generator>
+void Expander::appendSymbol(int symbol, int depth, Generator& random, OutputBuffer& output)
+{
+  if (Grammar::isTerminal(symbol) || grammar.getRule(symbol).length == 0) {
+    appendToken<kHashed>(symbol, output);
+    if (kProfiled) {
+      int tokens = grammar.getTokenCount(symbol);
+      numTokens += tokens;
+      if (!owners.empty()) profile->recordTokens(owners.back().nonterminal, tokens);
+    }
+    return;
+  }
+
+  int production = grammar.getRandomProduction(symbol, random);
+  if (kLimited) production = limitProduction(symbol, production, depth);
+  if (kProfiled) profile->recordExpansion(symbol, production);
+  Frame frame = { grammar.getSymbols(production), grammar.getSymbolsEnd(production), depth };
+  if (frame.next == frame.end) return;
+  stack.push_back(frame);
+  if (kProfiled) {
+    Owner owner = { symbol, numTokens };
+    owners.push_back(owner);
+    active[symbol]++;
+  }
+}
+
+void Expander::setProfile(ExpansionProfile& profile)
+{
+  this->profile = &profile;
+  active.assign(grammar.getNumNonterminals(), 0);
+  lastCharged.assign(grammar.getNumNonterminals(), -1);
+  numTokens = 0;
+  numSamples = 0;
+  untilSample = ExpansionProfile::kSampleInterval;
+  sampleSpacing = 2463534242u;
+  profiledRoot = -1;
+  lastSample = chrono::steady_clock::now();
+}
+
+void Expander::flushProfile()
+{
+  if (profile == NULL || profiledRoot == -1) return;
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  double seconds = chrono::duration<double>(now - lastSample).count();
+  lastSample = now;
+  profile->recordSelfTime(profiledRoot, seconds);
+  profile->recordTotalTime(profiledRoot, seconds);
+}
+
+/**
+ * Method: finishFrame
+ * -------------------
+ * Pops a profiled frame whose expansion is complete, and charges the
+ * tokens emitted since it was pushed to its nonterminal's total, unless
+ * an outer expansion of the same nonterminal is still in progress and
+ * will be charged for them anyway.
+ */
+
+void Expander::finishFrame()
+{
+  Owner owner = owners.back();
+  owners.pop_back();
+  stack.pop_back();
+  if (--active[owner.nonterminal] == 0)
+    profile->recordTotalTokens(owner.nonterminal, numTokens - owner.tokensBefore);
+}
+
+/**
+ * Method: takeSample
+ * ------------------
+ * Charges the time since the last sample to the nonterminal on top of the
+ * stack, and to every nonterminal on the stack at all, each only once no
+ * matter how many times it appears: lastCharged records the sample each
+ * nonterminal was last charged for.  The next sample is taken anywhere
+ * from half to one and a half intervals later, as chosen by a xorshift
+ * generator of its own, which leaves the random choices alone.
+ */
+
+void Expander::takeSample()
+{
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  double seconds = chrono::duration<double>(now - lastSample).count();
+  lastSample = now;
+  sampleSpacing ^= sampleSpacing << 13;
+  sampleSpacing ^= sampleSpacing >> 17;
+  sampleSpacing ^= sampleSpacing << 5;
+  untilSample = ExpansionProfile::kSampleInterval / 2 + sampleSpacing % ExpansionProfile::kSampleInterval;
+  numSamples++;
+  profile->recordSample();
+  profile->recordSelfTime(owners.back().nonterminal, seconds);
+  for (size_t i = owners.size(); i > 0; i--) {
+    int nonterminal = owners[i - 1].nonterminal;
+    if (lastCharged[nonterminal] == numSamples) continue;
+    lastCharged[nonterminal] = numSamples;
+    profile->recordTotalTime(nonterminal, seconds);
+  }
+}
+
+void Expander::setTargetLength(const LengthTable& table, int minLength, int maxLength)
+{
+  this->table = &table;
+  this->minLength = minLength;
+  this->maxLength = maxLength;
+}
+
+/**
+ * Method: appendToken
+ * -------------------
+ * Appends a terminal, or an undefined nonterminal's name, followed by a
+ * space, and folds it into the fingerprint if there's one to keep.
+ */
+
+template <bool kHashed>
+void Expander::appendToken(int symbol, OutputBuffer& output)
+{
+  if (Grammar::isTerminal(symbol)) {
+    int terminal = Grammar::getTerminalId(symbol);
+    output.append(grammar.getText(terminal), grammar.getTextLength(terminal));
+  } else {
+    string_view name = grammar.getNameView(symbol);
+    output.append(name.data(), name.size());
+  }
+  output.append(' ');
+  if (kHashed) fingerprint = fingerprinter->extend(fingerprint, symbol);
+}
+
+/**
+ * Method: expandTopDown
+ * ---------------------
+ * Works from the top down with a stack of pending symbols, each with the
+ * number of tokens its derivation must have.  Expanding a nonterminal
+ * picks a production that can derive that length and then deals the
+ * length out among the production's symbols, left to right, leaving the
+ * rest of the production able to derive what remains.  With a
+ * SentenceCounter, every choice is weighted by exactly the number of
+ * derivations it leads to, so each derivation comes out with the same
+ * probability.  With a LengthTable, no choice can lead to a dead end, so
+ * a sentence of the chosen length is produced in a single pass, with no
+ * retries.  The symbols are pushed in reverse, so the leftmost is
+ * expanded (and its terminals appended) first.
+ */
+
+template <class Sampler, class Generator>
+void Expander::expandTopDown(const Sampler& sampler, int nonterminal, Generator& random, OutputBuffer& output)
+{
+  pending.clear();
+  Pending first = { nonterminal, sampler.chooseLength(nonterminal, random) };
+  pending.push_back(first);
+  while (!pending.empty()) {
+    Pending item = pending.back();
+    pending.pop_back();
+    if (Grammar::isTerminal(item.symbol) || grammar.getRule(item.symbol).length == 0) {
+      if (fingerprinter != NULL) appendToken<true>(item.symbol, output);
+      else appendToken<false>(item.symbol, output);
+      continue;
+    }
+
+    int production = sampler.chooseProduction(item.symbol, item.length, random);
+    const int *symbols = grammar.getSymbols(production);
+    int numSymbols = grammar.getSymbolsEnd(production) - symbols;
+    lengths.clear();
+    int remaining = item.length;
+    for (int i = 0; i + 1 < numSymbols; i++) {
+      lengths.push_back(sampler.chooseSplit(production, i, remaining, random));
+      remaining -= lengths.back();
+    }
+    lengths.push_back(remaining);
+    for (int i = numSymbols - 1; i >= 0; i--) {
+      Pending next = { symbols[i], lengths[i] };
+      pending.push_back(next);
+    }
+  }
+}
+
+/**
+ * Methods: begin, next
+ * --------------------
+ * begin leaves a single frame on the stack holding just the nonterminal
+ * being expanded, one level above depth 0, so next can treat it like any
+ * other symbol.  next runs expand's loop until a symbol produces a token,
+ * and hands that back instead of appending it.
+ */
+
+void Expander::begin(int nonterminal)
+{
+  stack.clear();
+  root = nonterminal;
+  Frame frame = { &root, &root + 1, -1 };
+  stack.push_back(frame);
+  if (analysis != NULL) committed = analysis->getMinTokens(nonterminal);
+}
+
+template <class Generator>
+bool Expander::next(Generator& random, string_view& token)
+{
+  while (!stack.empty()) {
+    Frame& top = stack.back();
+    int symbol = *top.next++;
+    int depth = top.depth + 1;
+    if (top.next == top.end) stack.pop_back();
+    if (Grammar::isTerminal(symbol)) {
+      int terminal = Grammar::getTerminalId(symbol);
+      token = string_view(grammar.getText(terminal), grammar.getTextLength(terminal));
+      return true;
+    }
+    const Grammar::Span& rule = grammar.getRule(symbol);
+    if (rule.length == 0) {
+      token = grammar.getNameView(symbol);
+      return true;
+    }
+
+    int production = grammar.getRandomProduction(symbol, random);
+    if (analysis != NULL) production = limitProduction(symbol, production, depth);
+    Frame frame = { grammar.getSymbols(production), grammar.getSymbolsEnd(production), depth };
+    if (frame.next != frame.end) stack.push_back(frame);
+  }
+  return false;
+}
+
+template void Expander::expand(int nonterminal, RandomGenerator& random, OutputBuffer& output);
+template void Expander::expand(int nonterminal, PhiloxGenerator& random, OutputBuffer& output);
+template bool Expander::next(RandomGenerator& random, string_view& token);
+template bool Expander::next(PhiloxGenerator& random, string_view& token);
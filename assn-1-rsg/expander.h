@@ -0,0 +1,279 @@
+#ifndef __expander__
+#define __expander__
+
+/**
+ * File: expander.h
+ * ----------------
+ * Defines the Expander class, which generates random sentences from a
+ * compiled Grammar without recursion.  The expansion in progress lives on
+ * an explicit stack of partially consumed productions, so grammars that
+ * nest arbitrarily deeply can't overflow the C++ call stack, and every
+ * terminal is appended to the output the moment it's reached, so
+ * generating a sentence takes time proportional to the number of symbols
+ * visited.
+ *
+ * expand is a template over the generator the random choices are drawn
+ * from, which may be any class with a getRandomInteger(low, high) method.
+ * It's explicitly instantiated in expander.cc for RandomGenerator and
+ * PhiloxGenerator, the only two generators rsg uses.
+ *
+ * An Expander can also be given limits on the nesting depth and on the
+ * number of tokens in a sentence.  Once a limit would be exceeded, every
+ * nonterminal from then on is expanded with its shortest terminating
+ * production (see grammar-analysis.h) instead of a random one, so every
+ * sentence finishes, and finishes within the budget.  Alternatively, an
+ * Expander can be handed a SentenceCounter (see sentence-counter.h), in
+ * which case it samples whole derivations uniformly instead, or a
+ * LengthTable (see length-table.h), in which case every sentence has a
+ * length within a target range.
+ *
+ * Besides expanding whole sentences into an OutputBuffer, an Expander can
+ * be pulled from one token at a time: begin starts a sentence and each
+ * call to next expands just far enough to produce the next token.  Nothing
+ * is buffered, so the first token is available as soon as the leftmost
+ * derivation reaches it, and a consumer that stops early never pays for
+ * the rest of the sentence.
+ */
+
+#include "grammar.h"
+#include "grammar-analysis.h"
+#include "sentence-counter.h"
+#include "length-table.h"
+#include "fingerprinter.h"
+#include "expansion-profile.h"
+#include "random.h"
+#include "philox.h"
+#include "output-buffer.h"
+#include <string_view>
+#include <chrono>
+#include <vector>
+using namespace std;
+
+class Expander {
+
+ public:
+
+  /**
+   * Constructor: Expander
+   * ---------------------
+   * Constructs an Expander that generates from the specified grammar,
+   * which must outlive the Expander.
+   */
+
+  Expander(const Grammar& grammar) : grammar(grammar), analysis(NULL), counter(NULL), table(NULL),
+    fingerprinter(NULL), fingerprint(0), profile(NULL) {}
+
+  /**
+   * Method: setLimits
+   * -----------------
+   * Bounds every subsequent expansion.  A nonterminal nested maxDepth or
+   * more levels below the one being expanded (which is at depth 0) always
+   * takes its shortest production, as does any nonterminal for which the
+   * random choice would commit the sentence to more than maxTokens tokens.
+   * A sentence is committed to the tokens already appended plus the fewest
+   * that the symbols still on the stack can expand to, so the limit holds
+   * for the finished sentence unless the start symbol's own minimum exceeds
+   * it, in which case the sentence is as short as the grammar allows.
+   * maxTokens bounds the output, and maxDepth the work as well: a grammar
+   * with unit or empty cycles (<a> ::= <b>, <b> ::= <a>) can recur
+   * indefinitely without producing a token, but never below maxDepth.
+   *
+   * @param analysis the analysis of the Expander's grammar, which supplies
+   *                 the shortest productions and must outlive the Expander.
+   * @param maxDepth the depth limit, or INT_MAX for none.
+   * @param maxTokens the token limit, or LLONG_MAX for none.
+   */
+
+  void setLimits(const GrammarAnalysis& analysis, int maxDepth, long long maxTokens);
+
+  /**
+   * Method: setUniform
+   * ------------------
+   * Makes every subsequent expansion a derivation drawn uniformly from all
+   * of the nonterminal's derivations of at most counter.getMaxTokens()
+   * tokens, which overrides any limits.  The counter must have been built
+   * for this Expander's grammar, must be good, must give the nonterminal
+   * expanded at least one derivation, and must outlive the Expander.
+   * Uniform expansions are only available through expand, not next.
+   */
+
+  void setUniform(const SentenceCounter& counter) { this->counter = &counter; }
+
+  /**
+   * Method: setTargetLength
+   * -----------------------
+   * Makes every subsequent expansion have between minLength and maxLength
+   * tokens, inclusive, with each length the nonterminal can reach equally
+   * likely, and the productions otherwise chosen by weight among those
+   * that can still reach it.  This overrides any limits, but not
+   * setUniform.  maxLength may be no more than table.getMaxLength(), the
+   * nonterminal expanded must be able to reach some length in the range,
+   * and the table must outlive the Expander.  Like uniform expansions,
+   * these are only available through expand.
+   */
+
+  void setTargetLength(const LengthTable& table, int minLength, int maxLength);
+
+  /**
+   * Methods: setFingerprinter, getFingerprint
+   * -----------------------------------------
+   * setFingerprinter has every subsequent expand compute the fingerprint of
+   * the sentence it appends as it goes, and getFingerprint returns the
+   * fingerprint of the sentence the last expand appended.  The
+   * fingerprinter must have been built for this Expander's grammar and
+   * must outlive the Expander.
+   */
+
+  void setFingerprinter(const Fingerprinter& fingerprinter) { this->fingerprinter = &fingerprinter; }
+  uint64_t getFingerprint() const { return fingerprint; }
+
+  /**
+   * Method: setProfile
+   * ------------------
+   * Has every subsequent expand record what it does in the specified
+   * profile (see expansion-profile.h), which must have been built for
+   * this Expander's grammar and must outlive the Expander.  Profiling
+   * changes none of the random choices, so a profiled run generates the
+   * same sentences as an unprofiled one.  Only expand is profiled, and
+   * only when it's neither uniform nor targeted.
+   */
+
+  void setProfile(ExpansionProfile& profile);
+
+  /**
+   * Method: flushProfile
+   * --------------------
+   * Charges the time since the last sample, which would otherwise never be
+   * counted, to the nonterminal last expanded from the top.  Called once,
+   * when the Expander is done generating; does nothing without a profile.
+   */
+
+  void flushProfile();
+
+  /**
+   * Method: expand
+   * --------------
+   * Generates one random expansion of the specified nonterminal, appending
+   * each terminal (followed by a single space) to the output.  A nonterminal
+   * that's used but never defined is appended by name.  The stack is kept
+   * between calls, so that generating many sentences only allocates while
+   * the stack is still growing to the grammar's deepest nesting.
+   *
+   * @param nonterminal the ID of the nonterminal to expand.
+   * @param random the source of the random production choices.
+   * @param output the buffer the terminals are appended to.
+   */
+
+  template <class Generator>
+  void expand(int nonterminal, Generator& random, OutputBuffer& output);
+
+  /**
+   * Methods: begin, next
+   * --------------------
+   * begin starts a new expansion of the specified nonterminal, abandoning
+   * any expansion in progress, and next produces its tokens in order, one
+   * per call.  next makes the same random choices as expand, at the point
+   * the expansion first needs them, so the tokens of a begin/next sequence
+   * are exactly the words expand would have appended given the same
+   * generator.  Any limits set apply in the same way, but setUniform
+   * doesn't.
+   *
+   *    expander.begin(start);
+   *    string_view token;
+   *    while (expander.next(random, token)) send(token);
+   *
+   * @param nonterminal the ID of the nonterminal to expand.
+   * @param random the source of the random production choices, which must
+   *               be the same one for every call of a sentence.
+   * @param token set to the next terminal (or undefined nonterminal's name),
+   *              which stays valid for as long as the grammar does.
+   * @return false, leaving token alone, once the sentence is finished.
+   */
+
+  void begin(int nonterminal);
+
+  template <class Generator>
+  bool next(Generator& random, string_view& token);
+
+ private:
+
+  /**
+   * Convenience struct: Frame
+   * -------------------------
+   * The symbols of one chosen production that still need expanding, and
+   * the depth of the nonterminal that chose it.
+   */
+
+  struct Frame {
+    const int *next;
+    const int *end;
+    int depth;
+  };
+
+  const Grammar& grammar;
+  vector<Frame> stack;
+  const GrammarAnalysis *analysis;
+  int maxDepth;
+  long long maxTokens;
+  long long committed;
+  int root;
+
+  /**
+   * Convenience struct: Pending
+   * ---------------------------
+   * A symbol a uniform or targeted expansion has yet to expand, and the
+   * number of tokens its derivation has been allotted.
+   */
+
+  struct Pending {
+    int symbol;
+    int length;
+  };
+
+  const SentenceCounter *counter;
+  vector<Pending> pending;
+  vector<int> lengths;
+  BigInt scratch, term;
+  const LengthTable *table;
+  int minLength, maxLength;
+
+  const Fingerprinter *fingerprinter;
+  uint64_t fingerprint;
+
+  /**
+   * Convenience struct: Owner
+   * -------------------------
+   * The nonterminal a profiled frame's production belongs to, and the
+   * number of tokens emitted before it was pushed.  owners runs parallel
+   * to the stack.
+   */
+
+  struct Owner {
+    int nonterminal;
+    long long tokensBefore;
+  };
+
+  ExpansionProfile *profile;
+  vector<Owner> owners;
+  vector<int> active;
+  vector<long long> lastCharged;
+  long long numTokens, numSamples;
+  int untilSample;
+  uint32_t sampleSpacing;
+  int profiledRoot;
+  chrono::steady_clock::time_point lastSample;
+
+  template <class Sampler, class Generator>
+  void expandTopDown(const Sampler& sampler, int nonterminal, Generator& random, OutputBuffer& output);
+  template <bool kLimited, bool kHashed, bool kProfiled, class Generator>
+  void expandFrom(int nonterminal, Generator& random, OutputBuffer& output);
+  template <bool kLimited, bool kHashed, bool kProfiled, class Generator>
+  void appendSymbol(int symbol, int depth, Generator& random, OutputBuffer& output);
+  template <bool kHashed>
+  void appendToken(int symbol, OutputBuffer& output);
+  int limitProduction(int nonterminal, int production, int depth);
+  void finishFrame();
+  void takeSample();
+};
+
+#endif // ! __expander__
@@ -0,0 +1,27 @@
+/**
+ * File: expansion-profile.cc
+ * --------------------------
+ * Provides the implementation of the ExpansionProfile class.
+ */
+
+#include "expansion-profile.h"
+
+ExpansionProfile::ExpansionProfile(const Grammar& grammar) :
+  numSentences(0), numSamples(0), expansions(grammar.getNumNonterminals(), 0), choices(grammar.getNumProductions(), 0),
+  selfTokens(grammar.getNumNonterminals(), 0), totalTokens(grammar.getNumNonterminals(), 0),
+  selfSeconds(grammar.getNumNonterminals(), 0), totalSeconds(grammar.getNumNonterminals(), 0) {}
+
+void ExpansionProfile::merge(const ExpansionProfile& other)
+{
+  numSentences += other.numSentences;
+  numSamples += other.numSamples;
+  for (size_t nonterminal = 0; nonterminal < expansions.size(); nonterminal++) {
+    expansions[nonterminal] += other.expansions[nonterminal];
+    selfTokens[nonterminal] += other.selfTokens[nonterminal];
+    totalTokens[nonterminal] += other.totalTokens[nonterminal];
+    selfSeconds[nonterminal] += other.selfSeconds[nonterminal];
+    totalSeconds[nonterminal] += other.totalSeconds[nonterminal];
+  }
+  for (size_t production = 0; production < choices.size(); production++)
+    choices[production] += other.choices[production];
+}
@@ -0,0 +1,100 @@
+#ifndef __expansion_profile__
+#define __expansion_profile__
+
+/**
+ * File: expansion-profile.h
+ * -------------------------
+ * Defines the ExpansionProfile class, which an Expander fills in with
+ * per-nonterminal statistics as it generates (see Expander::setProfile):
+ * how many times each nonterminal was expanded and with which
+ * productions, how many tokens its productions emitted themselves and how
+ * many its expansions emitted in all, and how much time went into it.
+ * Every sentence drawn counts, including any thrown away afterwards as
+ * a duplicate.
+ *
+ * Self figures belong to a nonterminal's own productions, and total
+ * figures to everything its expansions led to.  A recursive nonterminal's
+ * total only counts its outermost expansions, so that no token or second
+ * is counted twice and no total exceeds the run's.
+ *
+ * Times are sampled rather than measured: every kSampleInterval symbols on
+ * average, the time since the last sample is charged to the nonterminal
+ * being expanded (its self time) and to each distinct nonterminal with an
+ * expansion in progress (their total times).  The gaps between samples
+ * vary, so they can't fall into step with a grammar that expands the same
+ * way every time and land on the same nonterminal again and again.
+ * Reading the clock that rarely costs next to nothing, and over a long run
+ * the samples add up to an accurate picture, including time spent writing
+ * the output.  A short run takes too few samples to say much.
+ */
+
+#include "grammar.h"
+#include <vector>
+using namespace std;
+
+class ExpansionProfile {
+
+ public:
+
+  static const int kSampleInterval = 1024;
+
+  /**
+   * Constructor: ExpansionProfile
+   * -----------------------------
+   * Constructs an empty profile for the specified grammar.
+   */
+
+  ExpansionProfile(const Grammar& grammar);
+
+  /**
+   * Method: merge
+   * -------------
+   * Adds the figures of another profile of the same grammar to this one,
+   * as when combining the profiles of several worker threads.
+   */
+
+  void merge(const ExpansionProfile& other);
+
+  /**
+   * Methods: record...
+   * ------------------
+   * Called by the Expander as it goes.
+   */
+
+  void recordSentence() { numSentences++; }
+  void recordSample() { numSamples++; }
+  void recordExpansion(int nonterminal, int production) { expansions[nonterminal]++; choices[production]++; }
+  void recordTokens(int nonterminal, int tokens) { selfTokens[nonterminal] += tokens; }
+  void recordTotalTokens(int nonterminal, long long tokens) { totalTokens[nonterminal] += tokens; }
+  void recordSelfTime(int nonterminal, double seconds) { selfSeconds[nonterminal] += seconds; }
+  void recordTotalTime(int nonterminal, double seconds) { totalSeconds[nonterminal] += seconds; }
+
+  /**
+   * Methods: get...
+   * ---------------
+   * Return the figures gathered so far.  getNumSentences returns the
+   * number of sentences drawn, and getChoices takes a production ID and
+   * returns the number of times it was chosen.
+   */
+
+  long long getNumSentences() const { return numSentences; }
+  long long getNumSamples() const { return numSamples; }
+  long long getExpansions(int nonterminal) const { return expansions[nonterminal]; }
+  long long getChoices(int production) const { return choices[production]; }
+  long long getSelfTokens(int nonterminal) const { return selfTokens[nonterminal]; }
+  long long getTotalTokens(int nonterminal) const { return totalTokens[nonterminal]; }
+  double getSelfSeconds(int nonterminal) const { return selfSeconds[nonterminal]; }
+  double getTotalSeconds(int nonterminal) const { return totalSeconds[nonterminal]; }
+
+ private:
+  long long numSentences;
+  long long numSamples;
+  vector<long long> expansions;
+  vector<long long> choices;
+  vector<long long> selfTokens;
+  vector<long long> totalTokens;
+  vector<double> selfSeconds;
+  vector<double> totalSeconds;
+};
+
+#endif // ! __expansion_profile__
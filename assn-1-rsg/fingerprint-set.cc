@@ -0,0 +1,41 @@
+/**
+ * File: fingerprint-set.cc
+ * ------------------------
+ * Provides the implementation of the FingerprintSet class.
+ */
+
+#include "fingerprint-set.h"
+
+FingerprintSet::FingerprintSet(long long maxSize) :
+  numSlots(maxSize + maxSize / 4 + 1)
+{
+  slots = new atomic<uint64_t>[numSlots]();
+}
+
+/**
+ * Method: insert
+ * --------------
+ * The home slot is found by scaling the fingerprint's top bits into
+ * [0, numSlots) with a multiply and shift rather than a division, which
+ * leaves the table free to be any size.  The fingerprints are hashes
+ * already, so their bits are evenly spread; they're multiplied by an odd
+ * constant first only because the top three bits of a value below 2^61
+ * are always zero.
+ */
+
+bool FingerprintSet::insert(uint64_t fingerprint)
+{
+  uint64_t key = fingerprint + 1;
+  uint64_t mixed = key * 0x9e3779b97f4a7c15ULL;
+  size_t slot = (size_t) (((unsigned __int128) mixed * numSlots) >> 64);
+  while (true) {
+    uint64_t current = slots[slot].load(memory_order_relaxed);
+    if (current == key) return false;
+    if (current == 0) {
+      if (slots[slot].compare_exchange_strong(current, key, memory_order_relaxed)) return true;
+      if (current == key) return false;
+      continue;
+    }
+    if (++slot == numSlots) slot = 0;
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef __fingerprint_set__
+#define __fingerprint_set__
+
+/**
+ * File: fingerprint-set.h
+ * -----------------------
+ * Defines the FingerprintSet class, a fixed-size set of the fingerprints
+ * of sentences already written (see fingerprinter.h), shared by every
+ * worker thread.
+ *
+ * It's an open addressing table of bare 64-bit words with linear probing,
+ * sized once for the number of fingerprints it will ever hold, so it takes
+ * 8 bytes per slot at a load factor of at most 0.8: 10 bytes per sentence.
+ * A fingerprint is always below 2^61 - 1, so it's stored plus one and
+ * an empty slot holds 0.  Slots only ever go from empty to full, with a
+ * single compare-and-swap, so insert needs no lock: of two threads inserting
+ * the same fingerprint at once, exactly one succeeds.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+using namespace std;
+
+class FingerprintSet {
+
+ public:
+
+  /**
+   * Constructor: FingerprintSet
+   * ---------------------------
+   * Constructs an empty set with room for the specified number of
+   * fingerprints.
+   */
+
+  FingerprintSet(long long maxSize);
+  ~FingerprintSet() { delete[] slots; }
+
+  /**
+   * Method: insert
+   * --------------
+   * Adds the specified fingerprint to the set, unless it's there already.
+   * No more than maxSize fingerprints may ever be inserted.
+   *
+   * @return true if the fingerprint is new, and false if it's a duplicate.
+   */
+
+  bool insert(uint64_t fingerprint);
+
+ private:
+  atomic<uint64_t> *slots;
+  size_t numSlots;
+
+  FingerprintSet(const FingerprintSet&);
+  FingerprintSet& operator=(const FingerprintSet&);
+};
+
+#endif // ! __fingerprint_set__
@@ -0,0 +1,41 @@
+/**
+ * File: fingerprinter.cc
+ * ----------------------
+ * Provides the implementation of the Fingerprinter class.
+ */
+
+#include "fingerprinter.h"
+#include <string_view>
+
+static const uint64_t kBase = 0x1b873593e0b7a4d5ULL % ((1ULL << 61) - 1);
+
+Fingerprinter::Fingerprinter(const Grammar& grammar)
+{
+  terminals.resize(grammar.getNumTerminals());
+  for (int terminal = 0; terminal < grammar.getNumTerminals(); terminal++)
+    terminals[terminal] = hashToken(grammar.getText(terminal), grammar.getTextLength(terminal));
+  names.resize(grammar.getNumNonterminals());
+  for (int nonterminal = 0; nonterminal < grammar.getNumNonterminals(); nonterminal++) {
+    string_view name = grammar.getNameView(nonterminal);
+    names[nonterminal] = hashToken(name.data(), name.size());
+  }
+}
+
+/**
+ * Method: hashToken
+ * -----------------
+ * Hashes the token's text followed by a space, one byte at a time.  Each
+ * byte counts as its value plus one, so that no byte hashes to nothing.
+ */
+
+Fingerprinter::Token Fingerprinter::hashToken(const char *text, int length)
+{
+  Token token = { 0, 1 };
+  for (int i = 0; i <= length; i++) {
+    unsigned char byte = i < length ? text[i] : ' ';
+    token.hash = multiply(token.hash, kBase) + byte + 1;
+    if (token.hash >= kPrime) token.hash -= kPrime;
+    token.power = multiply(token.power, kBase);
+  }
+  return token;
+}
@@ -0,0 +1,83 @@
+#ifndef __fingerprinter__
+#define __fingerprinter__
+
+/**
+ * File: fingerprinter.h
+ * ---------------------
+ * Defines the Fingerprinter class, which computes a fingerprint of a
+ * sentence (a 61-bit hash, held in a uint64_t) one token at a time, as
+ * the Expander appends it, so that duplicate sentences can be recognized
+ * without storing them or reading them back.
+ *
+ * The fingerprint of a sentence is a polynomial hash of its bytes modulo
+ * the Mersenne prime 2^61 - 1, each token counted with the space that
+ * follows it.  The hash of a concatenation is h(a) * B^|b| + h(b), so with
+ * every token's hash and B^length worked out in advance, appending a token
+ * costs one multiplication, whatever its length.  Since only the bytes
+ * matter, two derivations that spell out the same text (a chunk made by
+ * the optimizer and the words it was made from, say) get the same
+ * fingerprint, and two different sentences of n bytes collide with
+ * probability about n / 2^61.
+ */
+
+#include "grammar.h"
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+class Fingerprinter {
+
+ public:
+
+  /**
+   * Constructor: Fingerprinter
+   * --------------------------
+   * Hashes every terminal of the grammar and every nonterminal's name (which
+   * is what an undefined nonterminal expands to).
+   */
+
+  Fingerprinter(const Grammar& grammar);
+
+  /**
+   * Method: extend
+   * --------------
+   * Returns the fingerprint of a sentence with the specified fingerprint
+   * once the specified token (a terminal, or an undefined nonterminal) and
+   * its trailing space are appended.  An empty sentence's fingerprint is 0.
+   */
+
+  uint64_t extend(uint64_t fingerprint, int symbol) const
+  {
+    const Token& token = Grammar::isTerminal(symbol) ? terminals[Grammar::getTerminalId(symbol)] : names[symbol];
+    uint64_t sum = multiply(fingerprint, token.power) + token.hash;
+    return sum >= kPrime ? sum - kPrime : sum;
+  }
+
+ private:
+
+  /**
+   * Convenience struct: Token
+   * -------------------------
+   * A token's hash and B raised to its length, both modulo kPrime.
+   */
+
+  struct Token {
+    uint64_t hash;
+    uint64_t power;
+  };
+
+  static const uint64_t kPrime = (1ULL << 61) - 1;
+  vector<Token> terminals;
+  vector<Token> names;
+
+  static uint64_t multiply(uint64_t a, uint64_t b)
+  {
+    unsigned __int128 product = (unsigned __int128) a * b;
+    uint64_t sum = ((uint64_t) product & kPrime) + (uint64_t) (product >> 61);
+    return sum >= kPrime ? sum - kPrime : sum;
+  }
+
+  static Token hashToken(const char *text, int length);
+};
+
+#endif // ! __fingerprinter__
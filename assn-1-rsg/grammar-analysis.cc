@@ -0,0 +1,226 @@
+/**
+ * File: grammar-analysis.cc
+ * -------------------------
+ * Provides the implementation of the GrammarAnalysis class.
+ */
+
+#include "grammar-analysis.h"
+#include <math.h>
+#include <limits.h>
+#include <queue>
+#include <functional>
+
+const long long GrammarAnalysis::kUnbounded = LLONG_MAX;
+
+GrammarAnalysis::GrammarAnalysis(const Grammar& grammar, int start) : grammar(grammar)
+{
+  findReachable(start);
+  findMinimums();
+  findExpectations();
+}
+
+/**
+ * Method: findReachable
+ * ---------------------
+ * Depth first search from the start symbol, with an explicit stack.
+ */
+
+void GrammarAnalysis::findReachable(int start)
+{
+  reachable.assign(grammar.getNumNonterminals(), false);
+  if (start < 0) return;
+  vector<int> pending(1, start);
+  reachable[start] = true;
+  while (!pending.empty()) {
+    const Grammar::Span& rule = grammar.getRule(pending.back());
+    pending.pop_back();
+    for (int production = rule.start; production < rule.start + rule.length; production++) {
+      for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr) {
+        if (Grammar::isTerminal(*curr) || reachable[*curr]) continue;
+        reachable[*curr] = true;
+        pending.push_back(*curr);
+      }
+    }
+  }
+}
+
+/**
+ * Method: findMinimums
+ * --------------------
+ * The least fixed point of
+ *
+ *    min(A) = the minimum over A's productions of the sum of min(s) over
+ *             the production's symbols s,
+ *
+ * with each terminal counting its token count (see Grammar::getTokenCount)
+ * and undefined nonterminals counting 1, found with Knuth's generalization
+ * of Dijkstra's algorithm rather than by sweeping until nothing changes
+ * (which takes one sweep per level of a deep grammar).
+ * A production becomes a candidate once every nonterminal in it has its
+ * minimum settled, and nonterminals are settled in increasing order of
+ * their best candidate.  Whatever is never settled can't terminate.
+ * The order nonterminals settle in is kept, since each depends only on
+ * ones that settled before it, and so is every production's total, which
+ * is complete once none of its nonterminals are pending.
+ */
+
+void GrammarAnalysis::findMinimums()
+{
+  int numNonterminals = grammar.getNumNonterminals();
+  int numProductions = grammar.getNumProductions();
+  minTokens.assign(numNonterminals, kUnbounded);
+  shortestProduction.assign(numNonterminals, -1);
+  finishOrder.clear();
+
+  vector<int> owner(numProductions, -1), numPending(numProductions, 0);
+  vector<long long> total(numProductions, 0);
+  vector<int> userStart(numNonterminals + 1, 0), users;
+  for (int nonterminal = 0; nonterminal < numNonterminals; nonterminal++) {
+    const Grammar::Span& rule = grammar.getRule(nonterminal);
+    for (int production = rule.start; production < rule.start + rule.length; production++) {
+      owner[production] = nonterminal;
+      for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr)
+        if (Grammar::isNonterminal(*curr) && isDefined(*curr)) userStart[*curr + 1]++;
+    }
+  }
+  for (int i = 0; i < numNonterminals; i++) userStart[i + 1] += userStart[i];
+  users.resize(userStart[numNonterminals]);
+  vector<int> fill(userStart.begin(), userStart.end() - 1);
+
+  typedef pair<long long, int> candidate;
+  priority_queue<candidate, vector<candidate>, greater<candidate> > candidates;
+  for (int production = 0; production < numProductions; production++) {
+    if (owner[production] == -1) continue;
+    for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr) {
+      if (Grammar::isNonterminal(*curr) && isDefined(*curr)) {
+        users[fill[*curr]++] = production;
+        numPending[production]++;
+      } else {
+        total[production] += grammar.getTokenCount(*curr);
+      }
+    }
+    if (numPending[production] == 0) candidates.push(candidate(total[production], production));
+  }
+
+  while (!candidates.empty()) {
+    candidate best = candidates.top();
+    candidates.pop();
+    int nonterminal = owner[best.second];
+    if (minTokens[nonterminal] != kUnbounded) continue;
+    minTokens[nonterminal] = best.first;
+    shortestProduction[nonterminal] = best.second;
+    finishOrder.push_back(nonterminal);
+    for (int i = userStart[nonterminal]; i < userStart[nonterminal + 1]; i++) {
+      int production = users[i];
+      total[production] = min(total[production] + best.first, kUnbounded - 1);
+      if (--numPending[production] == 0) candidates.push(candidate(total[production], production));
+    }
+  }
+  for (int nonterminal = 0; nonterminal < numNonterminals; nonterminal++)
+    if (!isDefined(nonterminal)) minTokens[nonterminal] = 1;
+  productionMinTokens.assign(numProductions, kUnbounded);
+  for (int production = 0; production < numProductions; production++)
+    if (owner[production] != -1 && numPending[production] == 0) productionMinTokens[production] = total[production];
+}
+
+/**
+ * Method: findExpectations
+ * ------------------------
+ * The expectations satisfy the linear system
+ *
+ *    E(A) = the sum over A's productions p of Pr(p) times the sum of E(s)
+ *           over p's symbols s,
+ *
+ * and its least nonnegative solution is found by fixed-point iteration
+ * from zero, which increases monotonically toward it.  Sweeping in the
+ * order the minimums settled in means every nonrecursive nonterminal is
+ * exact after one sweep, so only recursive rules need more.  A
+ * nonterminal that can't terminate has an unbounded expectation from the
+ * outset.  If the sweeps haven't converged after kMaxSweeps, or the
+ * values have blown up past kHuge, the expectations still growing are
+ * unbounded (a critical or supercritical recursion), and so is every
+ * expectation that depends on one of them.
+ */
+
+static const int kMaxSweeps = 10000;
+static const double kTolerance = 1e-10;
+static const double kHuge = 1e18;
+
+void GrammarAnalysis::findExpectations()
+{
+  int numNonterminals = grammar.getNumNonterminals();
+  expectedTokens.assign(numNonterminals, 0);
+  expectedBytes.assign(numNonterminals, 0);
+  vector<int> order(finishOrder);
+  for (int nonterminal = 0; nonterminal < numNonterminals; nonterminal++) {
+    if (!isDefined(nonterminal)) {
+      expectedTokens[nonterminal] = 1;
+      expectedBytes[nonterminal] = grammar.getName(nonterminal).size() + 1;
+    } else if (!canTerminate(nonterminal)) {
+      expectedTokens[nonterminal] = expectedBytes[nonterminal] = HUGE_VAL;
+    }
+  }
+
+  vector<double> probabilities;
+  vector<bool> changing(numNonterminals, false);
+  bool converged = false;
+  for (int sweep = 0; sweep < kMaxSweeps && !converged; sweep++) {
+    converged = true;
+    for (int i = 0; i < (int) order.size(); i++) {
+      int nonterminal = order[i];
+      const Grammar::Span& rule = grammar.getRule(nonterminal);
+      grammar.getProductionProbabilities(nonterminal, probabilities);
+      double tokens = 0, bytes = 0;
+      for (int j = 0; j < rule.length; j++) {
+        if (probabilities[j] == 0) continue;
+        int production = rule.start + j;
+        double productionTokens = 0, productionBytes = 0;
+        for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr) {
+          if (Grammar::isTerminal(*curr)) {
+            productionTokens += grammar.getTokenCount(*curr);
+            productionBytes += grammar.getTextLength(Grammar::getTerminalId(*curr)) + 1;
+          } else {
+            productionTokens += expectedTokens[*curr];
+            productionBytes += expectedBytes[*curr];
+          }
+        }
+        tokens += probabilities[j] * productionTokens;
+        bytes += probabilities[j] * productionBytes;
+      }
+      changing[nonterminal] = tokens - expectedTokens[nonterminal] > kTolerance * max(1.0, tokens) ||
+                              bytes - expectedBytes[nonterminal] > kTolerance * max(1.0, bytes);
+      if (changing[nonterminal]) converged = false;
+      expectedTokens[nonterminal] = tokens;
+      expectedBytes[nonterminal] = bytes;
+      if (tokens > kHuge || bytes > kHuge) {
+        expectedTokens[nonterminal] = expectedBytes[nonterminal] = HUGE_VAL;
+        changing[nonterminal] = false;
+      }
+    }
+  }
+  if (converged) return;
+  for (int nonterminal = 0; nonterminal < numNonterminals; nonterminal++)
+    if (changing[nonterminal]) expectedTokens[nonterminal] = expectedBytes[nonterminal] = HUGE_VAL;
+
+  bool spreading = true;
+  while (spreading) {
+    spreading = false;
+    for (int i = 0; i < (int) order.size(); i++) {
+      int nonterminal = order[i];
+      if (expectedTokens[nonterminal] == HUGE_VAL) continue;
+      const Grammar::Span& rule = grammar.getRule(nonterminal);
+      grammar.getProductionProbabilities(nonterminal, probabilities);
+      for (int j = 0; j < rule.length && expectedTokens[nonterminal] != HUGE_VAL; j++) {
+        if (probabilities[j] == 0) continue;
+        int production = rule.start + j;
+        for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr) {
+          if (Grammar::isNonterminal(*curr) && expectedTokens[*curr] == HUGE_VAL) {
+            expectedTokens[nonterminal] = expectedBytes[nonterminal] = HUGE_VAL;
+            spreading = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef __grammar_analysis__
+#define __grammar_analysis__
+
+/**
+ * File: grammar-analysis.h
+ * ------------------------
+ * Defines the GrammarAnalysis class, which examines a compiled Grammar
+ * before anything is generated from it and works out, for every
+ * nonterminal:
+ *
+ *    whether it's defined at all (an undefined one expands to its own
+ *    name, which is what the Expander does with it);
+ *    whether it's reachable from the start symbol;
+ *    whether it can terminate, meaning that some sequence of choices
+ *    expands it to nothing but terminals;
+ *    the fewest tokens it can expand to, and the production to pick to
+ *    achieve that;
+ *    the expected number of tokens and bytes it expands to, given the
+ *    production weights, which may be unbounded even if it can terminate.
+ *
+ * The expected bytes of the start symbol are what an output buffer
+ * should be sized for.  A start symbol that can't terminate would never
+ * finish, and one with an unbounded expected length may not.
+ */
+
+#include "grammar.h"
+#include <vector>
+using namespace std;
+
+class GrammarAnalysis {
+
+ public:
+
+  /**
+   * Constant: kUnbounded
+   * --------------------
+   * The minimum number of tokens of a nonterminal that can't terminate.
+   * Minimums too large to count saturate at this value too.
+   */
+
+  static const long long kUnbounded;
+
+  /**
+   * Constructor: GrammarAnalysis
+   * ----------------------------
+   * Analyzes the specified grammar with respect to the specified start
+   * symbol.  The grammar must outlive the analysis.
+   */
+
+  GrammarAnalysis(const Grammar& grammar, int start);
+
+  /**
+   * Predicates: isDefined, isReachable, canTerminate
+   * ------------------------------------------------
+   * See the file comment.
+   */
+
+  bool isDefined(int nonterminal) const { return grammar.getRule(nonterminal).length > 0; }
+  bool isReachable(int nonterminal) const { return reachable[nonterminal]; }
+  bool canTerminate(int nonterminal) const { return minTokens[nonterminal] != kUnbounded; }
+
+  /**
+   * Methods: getMinTokens, getShortestProduction
+   * --------------------------------------------
+   * Return the fewest tokens the nonterminal can expand to (kUnbounded if
+   * it can't terminate), and the ID of the production that leads to that
+   * expansion (-1 if it can't terminate or isn't defined).
+   */
+
+  long long getMinTokens(int nonterminal) const { return minTokens[nonterminal]; }
+  int getShortestProduction(int nonterminal) const { return shortestProduction[nonterminal]; }
+
+  /**
+   * Method: getProductionMinTokens
+   * ------------------------------
+   * Returns the fewest tokens the specified production can expand to,
+   * which is kUnbounded if any of its nonterminals can't terminate.
+   */
+
+  long long getProductionMinTokens(int production) const { return productionMinTokens[production]; }
+
+  /**
+   * Methods: getExpectedTokens, getExpectedBytes
+   * --------------------------------------------
+   * Return the expected number of tokens, and of bytes of output (each
+   * token followed by a space), that the nonterminal expands to.  Both are
+   * HUGE_VAL if the expectation is unbounded.
+   */
+
+  double getExpectedTokens(int nonterminal) const { return expectedTokens[nonterminal]; }
+  double getExpectedBytes(int nonterminal) const { return expectedBytes[nonterminal]; }
+
+ private:
+  const Grammar& grammar;
+  vector<bool> reachable;
+  vector<long long> minTokens;
+  vector<int> shortestProduction;
+  vector<long long> productionMinTokens;
+  vector<double> expectedTokens;
+  vector<double> expectedBytes;
+  vector<int> finishOrder;
+
+  void findReachable(int start);
+  void findMinimums();
+  void findExpectations();
+};
+
+#endif // ! __grammar_analysis__
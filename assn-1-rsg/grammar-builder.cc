@@ -0,0 +1,137 @@
+/**
+ * File: grammar-builder.cc
+ * ------------------------
+ * Provides the implementation of the GrammarBuilder class.
+ */
+
+#include "grammar-builder.h"
+#include "grammar-image.h"
+#include "alias-table.h"
+#include <string.h>
+
+Grammar::Span GrammarBuilder::appendText(string_view token)
+{
+  Grammar::Span span = { (int) text.size(), (int) token.size() };
+  text.insert(text.end(), token.begin(), token.end());
+  return span;
+}
+
+/**
+ * Method: internNonterminal
+ * -------------------------
+ * A new nonterminal starts out with an empty rule, which is what it keeps
+ * if it's used but never defined.
+ */
+
+int GrammarBuilder::internNonterminal(string_view name)
+{
+  unordered_map<string_view, int>::iterator found = nonterminalIds.find(name);
+  if (found != nonterminalIds.end()) return found->second;
+  int id = rules.size();
+  Grammar::Span rule = { 0, 0 };
+  rules.push_back(rule);
+  defined.push_back(false);
+  names.push_back(appendText(name));
+  nonterminalIds[name] = id;
+  return id;
+}
+
+int GrammarBuilder::intern(string_view token)
+{
+  if (token.size() >= 2 && token.front() == '<' && token.back() == '>') return internNonterminal(token);
+  return internTerminal(token, 1);
+}
+
+int GrammarBuilder::internTerminal(string_view text, int numTokens)
+{
+  unordered_map<string_view, int>::iterator found = terminalIds.find(text);
+  if (found != terminalIds.end()) return ~found->second;
+  int id = terminals.size();
+  terminals.push_back(appendText(text));
+  tokenCounts.push_back(numTokens);
+  terminalIds[text] = id;
+  return ~id;
+}
+
+/**
+ * Method: beginDefinition
+ * -----------------------
+ * A redefinition leaves the earlier productions in place, unreferenced,
+ * since the new ones have to be contiguous and start after them anyway.
+ */
+
+void GrammarBuilder::beginDefinition(int nonterminal)
+{
+  if (!defined[nonterminal]) numDefinitions++;
+  defined[nonterminal] = true;
+  currentRule = nonterminal;
+  rules[nonterminal].start = productions.size();
+  rules[nonterminal].length = 0;
+}
+
+void GrammarBuilder::beginProduction(double weight)
+{
+  Grammar::Span production = { (int) symbols.size(), 0 };
+  productions.push_back(production);
+  weights.push_back(weight);
+  rules[currentRule].length++;
+}
+
+/**
+ * Function: appendSection
+ * -----------------------
+ * Appends the specified array to the image, padded to a multiple of
+ * four bytes, and returns the offset it was placed at.
+ */
+
+template <class T>
+static uint32_t appendSection(vector<char>& image, const vector<T>& array)
+{
+  uint32_t offset = image.size();
+  const char *bytes = (const char *) array.data();
+  image.insert(image.end(), bytes, bytes + array.size() * sizeof(T));
+  image.resize((image.size() + 3) & ~(size_t) 3, '\0');
+  return offset;
+}
+
+void GrammarBuilder::build(vector<char>& image) const
+{
+  vector<unsigned char> weighted(rules.size(), 0);
+  vector<uint32_t> thresholds(productions.size(), AliasTable::kOne);
+  vector<int> aliases(productions.size());
+  for (int i = 0; i < (int) productions.size(); i++) aliases[i] = i;
+  for (int nonterminal = 0; nonterminal < (int) rules.size(); nonterminal++) {
+    const Grammar::Span& rule = rules[nonterminal];
+    vector<double> ruleWeights(weights.begin() + rule.start, weights.begin() + rule.start + rule.length);
+    AliasTable table(ruleWeights);
+    weighted[nonterminal] = !table.isUniform();
+    for (int column = 0; column < rule.length; column++) {
+      thresholds[rule.start + column] = table.getThreshold(column);
+      aliases[rule.start + column] = rule.start + table.getAlias(column);
+    }
+  }
+
+  grammarImageHeader header;
+  memset(&header, 0, sizeof(header));
+  image.assign(sizeof(header), '\0');
+  memcpy(header.magic, kGrammarMagic, sizeof(kGrammarMagic));
+  header.byteOrderMark = kGrammarByteOrderMark;
+  header.version = kGrammarFormatVersion;
+  header.numNonterminals = rules.size();
+  header.numProductions = productions.size();
+  header.numSymbols = symbols.size();
+  header.numTerminals = terminals.size();
+  header.textSize = text.size();
+  header.rulesOffset = appendSection(image, rules);
+  header.productionsOffset = appendSection(image, productions);
+  header.symbolsOffset = appendSection(image, symbols);
+  header.terminalsOffset = appendSection(image, terminals);
+  header.namesOffset = appendSection(image, names);
+  header.weightedOffset = appendSection(image, weighted);
+  header.thresholdsOffset = appendSection(image, thresholds);
+  header.aliasesOffset = appendSection(image, aliases);
+  header.tokenCountsOffset = appendSection(image, tokenCounts);
+  header.textOffset = appendSection(image, text);
+  header.imageSize = image.size();
+  memcpy(image.data(), &header, sizeof(header));
+}
@@ -0,0 +1,103 @@
+#ifndef __grammar_builder__
+#define __grammar_builder__
+
+/**
+ * File: grammar-builder.h
+ * -----------------------
+ * Defines the GrammarBuilder class, which accumulates a grammar one
+ * definition, production and symbol at a time and then lays it out as a
+ * Grammar image (see grammar-image.h).  Tokens are handed over as
+ * string_views and interned through hash tables keyed by those same
+ * views, so a token's characters are only copied the first time it's
+ * seen, and only into the image's text arena.  The views must stay valid
+ * for as long as more tokens are being interned; build doesn't need them.
+ *
+ * Productions belong to the most recently begun definition.  If a
+ * nonterminal is defined more than once, the last definition wins, just
+ * as it does when readGrammar stores Definitions in a map.
+ */
+
+#include "grammar.h"
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+class GrammarBuilder {
+
+ public:
+
+  /**
+   * Method: internNonterminal
+   * -------------------------
+   * Returns the ID of the nonterminal with the specified name, whether
+   * or not the name is of the form <...>.
+   */
+
+  int internNonterminal(string_view name);
+
+  /**
+   * Method: intern
+   * --------------
+   * Returns the symbol for the specified token: a nonterminal ID if the
+   * token starts with '<' and ends with '>', and ~(terminal ID) otherwise.
+   */
+
+  int intern(string_view token);
+
+  /**
+   * Method: internTerminal
+   * ----------------------
+   * Returns ~(terminal ID) for the specified text, even if it's of the
+   * form <...>.  numTokens is the number of tokens the text stands for,
+   * which is 1 except for the optimizer's chunks (see grammar-optimizer.h);
+   * the same text always stands for the same number.
+   */
+
+  int internTerminal(string_view text, int numTokens);
+
+  /**
+   * Methods: beginDefinition, beginProduction, addSymbol
+   * ----------------------------------------------------
+   * beginDefinition discards whatever productions the nonterminal had and
+   * starts collecting new ones, beginProduction starts a new production with
+   * the specified weight, and addSymbol appends a symbol (as returned by
+   * intern) to it.
+   */
+
+  void beginDefinition(int nonterminal);
+  void beginProduction(double weight);
+  void addSymbol(int symbol) { symbols.push_back(symbol); productions.back().length++; }
+
+  /**
+   * Method: getNumDefinitions
+   * -------------------------
+   * Returns the number of distinct nonterminals defined so far.
+   */
+
+  int getNumDefinitions() const { return numDefinitions; }
+
+  /**
+   * Method: build
+   * -------------
+   * Computes each rule's alias table and lays everything out as an image.
+   *
+   * @param image replaced with the finished image.
+   */
+
+  void build(vector<char>& image) const;
+
+ private:
+  vector<Grammar::Span> rules, productions, terminals, names;
+  vector<int> symbols, tokenCounts;
+  vector<double> weights;
+  vector<char> text;
+  vector<bool> defined;
+  unordered_map<string_view, int> nonterminalIds, terminalIds;
+  int currentRule = -1;
+  int numDefinitions = 0;
+
+  Grammar::Span appendText(string_view token);
+};
+
+#endif // ! __grammar_builder__
@@ -0,0 +1,212 @@
+/**
+ * File: grammar-emitter.cc
+ * ------------------------
+ * Provides the implementation of the grammar emitter.
+ */
+
+#include "grammar-emitter.h"
+#include "alias-table.h"
+#include <stdio.h>
+
+/**
+ * Function: quote
+ * ---------------
+ * Returns the specified text as a C++ string literal.  Quotes and
+ * backslashes are escaped, and so is anything unprintable, in octal so
+ * that a digit following it can't be taken as part of the escape.
+ */
+
+static string quote(const string& text)
+{
+  string literal = "\"";
+  for (size_t i = 0; i < text.size(); i++) {
+    unsigned char ch = text[i];
+    if (ch == '"' || ch == '\\') {
+      literal += '\\';
+      literal += ch;
+    } else if (ch < ' ' || ch > '~') {
+      char escape[5];
+      snprintf(escape, sizeof(escape), "\\%03o", ch);
+      literal += escape;
+    } else {
+      literal += ch;
+    }
+  }
+  return literal + "\"";
+}
+
+static string functionName(int nonterminal)
+{
+  return "expand" + to_string(nonterminal);
+}
+
+/**
+ * Function: emitProduction
+ * ------------------------
+ * Writes the statements that expand one production: a call for each
+ * defined nonterminal, and one append for each run of terminals and
+ * undefined nonterminals in between, with the separating spaces baked
+ * into the literal.
+ */
+
+static void emitProduction(const Grammar& grammar, int production, const string& indent, ostream& out)
+{
+  string run;
+  for (const int *curr = grammar.getSymbols(production); ; ++curr) {
+    bool done = curr == grammar.getSymbolsEnd(production);
+    if (!done && Grammar::isTerminal(*curr)) {
+      int terminal = Grammar::getTerminalId(*curr);
+      run.append(grammar.getText(terminal), grammar.getTextLength(terminal));
+      run += ' ';
+      continue;
+    }
+    if (!done && grammar.getRule(*curr).length == 0) {
+      run += grammar.getName(*curr) + ' ';
+      continue;
+    }
+    if (!run.empty()) {
+      out << indent << "output.append(" << quote(run) << ", " << run.size() << ");" << endl;
+      run.clear();
+    }
+    if (done) return;
+    out << indent << functionName(*curr) << "(random, output);" << endl;
+  }
+}
+
+/**
+ * Function: emitRule
+ * ------------------
+ * Writes the function for one defined nonterminal.  The production is
+ * drawn exactly as Grammar::getRandomProduction draws it, with the alias
+ * table of a weighted rule emitted alongside the function, and a rule
+ * with a single production still makes its draw so the streams stay in step.
+ */
+
+static void emitRule(const Grammar& grammar, int nonterminal, ostream& out)
+{
+  const Grammar::Span& rule = grammar.getRule(nonterminal);
+  string name = functionName(nonterminal);
+  out << endl << "// " << grammar.getName(nonterminal) << endl;
+  if (grammar.isWeighted(nonterminal)) {
+    out << "static const uint32_t " << name << "Thresholds[] = {";
+    for (int i = 0; i < rule.length; i++)
+      out << (i == 0 ? " " : ", ") << grammar.getThreshold(rule.start + i);
+    out << " };" << endl << "static const int " << name << "Aliases[] = {";
+    for (int i = 0; i < rule.length; i++)
+      out << (i == 0 ? " " : ", ") << grammar.getAlias(rule.start + i) - rule.start;
+    out << " };" << endl;
+  }
+
+  out << "static void " << name << "(RandomGenerator& random, OutputBuffer& output)" << endl << "{" << endl;
+  if (rule.length == 1) {
+    out << "  random.getRandomInteger(0, 0);" << endl;
+    emitProduction(grammar, rule.start, "  ", out);
+    out << "}" << endl;
+    return;
+  }
+
+  out << "  int production = random.getRandomInteger(0, " << rule.length - 1 << ");" << endl;
+  if (grammar.isWeighted(nonterminal))
+    out << "  if ((uint32_t) random.getRandomInteger(0, " << AliasTable::kOne - 1 << ") >= "
+        << name << "Thresholds[production])" << endl
+        << "    production = " << name << "Aliases[production];" << endl;
+  out << "  switch (production) {" << endl;
+  for (int i = 0; i < rule.length; i++) {
+    out << "    case " << i << ":" << endl;
+    emitProduction(grammar, rule.start + i, "      ", out);
+    out << "      return;" << endl;
+  }
+  out << "  }" << endl << "}" << endl;
+}
+
+/**
+ * Constant: kMain
+ * ---------------
+ * The emitted program's main function, which expands START_FUNCTION.
+ */
+
+static const char *const kMain = R"(
+int main(int argc, char *argv[])
+{
+  long long count = 1;
+  uint64_t seed = 0;
+  bool seeded = false, bulk = false;
+  const char *outputFile = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+      count = atoll(argv[++i]);
+      bulk = true;
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 0);
+      seeded = true;
+    } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+      outputFile = argv[++i];
+    } else {
+      cerr << "Usage: " << argv[0] << " [--count N] [--seed N] [--output FILE]" << endl;
+      return 1;
+    }
+  }
+  if (!seeded) seed = RandomGenerator().next();
+
+  int fd = STDOUT_FILENO;
+  if (outputFile != NULL && (fd = open(outputFile, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1) {
+    cerr << "Failed to open the file named \"" << outputFile << "\" for writing." << endl;
+    return 2;
+  }
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  RandomGenerator random(seed);
+  OutputBuffer output(fd);
+  for (long long i = 0; i < count; i++) {
+    START_FUNCTION(random, output);
+    output.endLine();
+    output.endSentence();
+  }
+  bool ok = output.flush();
+  if (outputFile != NULL && close(fd) == -1) ok = false;
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  if (bulk) {
+    double megabytes = output.getBytesWritten() / (1024.0 * 1024.0);
+    cerr << "Generated " << count << " sentences (" << fixed << setprecision(1) << megabytes
+         << " MB) in " << setprecision(3) << elapsed << "s: " << setprecision(1)
+         << (elapsed > 0 ? megabytes / elapsed : 0) << " MB/s (seed " << seed << ")." << endl;
+  }
+  if (!ok) {
+    cerr << "Failed to write all of the generated sentences." << endl;
+    return 4;
+  }
+  return 0;
+}
+)";
+
+bool emitGeneratorSource(const Grammar& grammar, const GrammarAnalysis& analysis, int start,
+                         const string& grammarFile, ostream& out)
+{
+  out << "/**" << endl
+      << " * Generated by rsg --emit-cpp from \"" << grammarFile << "\".  Don't edit it;" << endl
+      << " * regenerate it instead.  Link it against random.o and output-buffer.o." << endl
+      << " */" << endl << endl
+      << "#include \"random.h\"" << endl
+      << "#include \"output-buffer.h\"" << endl
+      << "#include <iostream>" << endl
+      << "#include <iomanip>" << endl
+      << "#include <chrono>" << endl
+      << "#include <stdint.h>" << endl
+      << "#include <stdlib.h>" << endl
+      << "#include <string.h>" << endl
+      << "#include <fcntl.h>" << endl
+      << "#include <unistd.h>" << endl
+      << "using namespace std;" << endl << endl;
+
+  for (int nonterminal = 0; nonterminal < grammar.getNumNonterminals(); nonterminal++)
+    if (analysis.isReachable(nonterminal) && analysis.isDefined(nonterminal))
+      out << "static void " << functionName(nonterminal) << "(RandomGenerator& random, OutputBuffer& output);" << endl;
+  for (int nonterminal = 0; nonterminal < grammar.getNumNonterminals(); nonterminal++)
+    if (analysis.isReachable(nonterminal) && analysis.isDefined(nonterminal)) emitRule(grammar, nonterminal, out);
+
+  string program = kMain;
+  string placeholder = "START_FUNCTION";
+  program.replace(program.find(placeholder), placeholder.size(), functionName(start));
+  out << program;
+  return !out.fail();
+}
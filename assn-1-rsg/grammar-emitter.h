@@ -0,0 +1,49 @@
+#ifndef __grammar_emitter__
+#define __grammar_emitter__
+
+/**
+ * File: grammar-emitter.h
+ * -----------------------
+ * Declares the grammar emitter, which turns a compiled Grammar into the
+ * source of a standalone C++ program that generates from that one grammar
+ * with no interpretation at all.  Every defined nonterminal becomes a
+ * function that draws a production and switches over the choices, and
+ * every run of terminals becomes a single append of a string literal whose
+ * length is a compile-time constant, so the compiler turns it into a
+ * fixed-size memcpy.
+ *
+ * The emitted program links against random.o and output-buffer.o, and
+ * makes exactly the draws the Expander would, in the same order, so it
+ * generates the same sentences as rsg for the same seed.  Nested
+ * nonterminals nest C++ calls, so unlike the Expander it's limited by the
+ * depth of the call stack, although a call in tail position is compiled
+ * as a jump at -O2, so right recursion is free.
+ */
+
+#include "grammar.h"
+#include "grammar-analysis.h"
+#include <ostream>
+#include <string>
+using namespace std;
+
+/**
+ * Function: emitGeneratorSource
+ * -----------------------------
+ * Writes the source of the generator program for the specified grammar,
+ * with a function for every defined nonterminal reachable from the start
+ * symbol.  The program accepts --count N, --seed N and --output FILE, just
+ * as rsg does, and reports its throughput on cerr when given --count.
+ *
+ * @param grammar the grammar to generate from.
+ * @param analysis the analysis of the grammar with respect to start.
+ * @param start the ID of the defined nonterminal every sentence expands.
+ * @param grammarFile the file the grammar came from, which is only quoted
+ *                    in the emitted file's header comment.
+ * @param out the stream the source is written to.
+ * @return true if and only if the source was written successfully.
+ */
+
+bool emitGeneratorSource(const Grammar& grammar, const GrammarAnalysis& analysis, int start,
+                         const string& grammarFile, ostream& out);
+
+#endif // ! __grammar_emitter__
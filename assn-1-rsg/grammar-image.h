@@ -0,0 +1,59 @@
+#ifndef __grammar_image__
+#define __grammar_image__
+
+/**
+ * File: grammar-image.h
+ * ---------------------
+ * Describes the binary image a compiled Grammar is stored in, both in
+ * memory and in the .rsgc files written by rsg --compile.  An image is a
+ * fixed size header followed by the Grammar's arrays, each starting at a
+ * four byte aligned offset from the start of the image.  Since nothing in
+ * the image is a pointer, an image can be mapped at any address and used
+ * in place, with no parsing and no allocation.
+ *
+ * Images are written in the host's byte order, and one whose
+ * byteOrderMark doesn't read back as kGrammarByteOrderMark (an image
+ * compiled on a machine of the other byte order) is rejected rather than
+ * swapped; recompiling from the .g file is cheap.
+ */
+
+#include <stdint.h>
+
+static const char kGrammarMagic[4] = { 'R', 'S', 'G', 'C' };
+static const uint32_t kGrammarByteOrderMark = 0x01020304;
+static const uint32_t kGrammarFormatVersion = 2;
+
+/**
+ * Struct: grammarImageHeader
+ * --------------------------
+ * The counts of each kind of entry, and the offset of each array from
+ * the start of the image.  rules, productions, terminals and names are
+ * arrays of Grammar::Span; symbols, aliases and tokenCounts (one per
+ * terminal) are arrays of int32_t, thresholds an array of uint32_t,
+ * weighted an array of one byte flags (one per nonterminal), and text an
+ * array of chars.
+ */
+
+struct grammarImageHeader {
+  char magic[4];
+  uint32_t byteOrderMark;
+  uint32_t version;
+  uint32_t imageSize;
+  uint32_t numNonterminals;
+  uint32_t numProductions;
+  uint32_t numSymbols;
+  uint32_t numTerminals;
+  uint32_t textSize;
+  uint32_t rulesOffset;
+  uint32_t productionsOffset;
+  uint32_t symbolsOffset;
+  uint32_t terminalsOffset;
+  uint32_t namesOffset;
+  uint32_t weightedOffset;
+  uint32_t thresholdsOffset;
+  uint32_t aliasesOffset;
+  uint32_t tokenCountsOffset;
+  uint32_t textOffset;
+};
+
+#endif // ! __grammar_image__
@@ -0,0 +1,178 @@
+/**
+ * File: grammar-optimizer.cc
+ * --------------------------
+ * Provides the implementation of the grammar optimizer.
+ */
+
+#include "grammar-optimizer.h"
+#include <deque>
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * Function: isText
+ * ----------------
+ * Returns true if and only if the specified symbol always expands to the
+ * same single token: a terminal, or an undefined nonterminal's name.
+ */
+
+static bool isText(const Grammar& grammar, int symbol)
+{
+  return Grammar::isTerminal(symbol) || grammar.getRule(symbol).length == 0;
+}
+
+static string getText(const Grammar& grammar, int symbol)
+{
+  if (Grammar::isNonterminal(symbol)) return grammar.getName(symbol);
+  int terminal = Grammar::getTerminalId(symbol);
+  return string(grammar.getText(terminal), grammar.getTextLength(terminal));
+}
+
+/**
+ * Function: appendInlined
+ * -----------------------
+ * Appends the symbols of the specified production to body, with each
+ * inlinable nonterminal replaced by its (already inlined) body.
+ */
+
+static void appendInlined(const Grammar& grammar, int production, const vector<bool>& inlinable,
+                          const vector<vector<int> >& bodies, vector<int>& body)
+{
+  for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr) {
+    if (Grammar::isNonterminal(*curr) && inlinable[*curr])
+      body.insert(body.end(), bodies[*curr].begin(), bodies[*curr].end());
+    else
+      body.push_back(*curr);
+  }
+}
+
+/**
+ * Function: findInlinable
+ * -----------------------
+ * Decides which nonterminals reachable from the start symbol are
+ * inlined, and works out their inlined bodies.  A depth first search
+ * with an explicit stack visits the callees of each nonterminal before
+ * finishing it, so by the time a nonterminal's body is inlined, every
+ * inlinable nonterminal it uses has been inlined already.  A nonterminal
+ * that's reached again while it's still being searched is recursive, and
+ * every cycle of the grammar contains at least one of those, so inlining
+ * everything else always stops.
+ */
+
+struct Visit {
+  int nonterminal;
+  int production;
+  const int *next;
+  const int *end;
+};
+
+static void findInlinable(const Grammar& grammar, int start, vector<bool>& inlinable,
+                          vector<vector<int> >& bodies)
+{
+  enum { kUnvisited, kInProgress, kFinished };
+  int numNonterminals = grammar.getNumNonterminals();
+  vector<unsigned char> state(numNonterminals, kUnvisited);
+  vector<bool> recursive(numNonterminals, false);
+  inlinable.assign(numNonterminals, false);
+  bodies.assign(numNonterminals, vector<int>());
+
+  vector<Visit> stack;
+  int pending = start;
+  while (pending != -1 || !stack.empty()) {
+    if (pending != -1) {
+      int production = grammar.getRule(pending).start;
+      Visit visit = { pending, production, grammar.getSymbols(production), grammar.getSymbolsEnd(production) };
+      state[pending] = kInProgress;
+      stack.push_back(visit);
+      pending = -1;
+    }
+
+    Visit& top = stack.back();
+    if (top.next != top.end) {
+      int symbol = *top.next++;
+      if (isText(grammar, symbol)) continue;
+      if (state[symbol] == kInProgress) recursive[symbol] = true;
+      else if (state[symbol] == kUnvisited) pending = symbol;
+      continue;
+    }
+    const Grammar::Span& rule = grammar.getRule(top.nonterminal);
+    if (++top.production < rule.start + rule.length) {
+      top.next = grammar.getSymbols(top.production);
+      top.end = grammar.getSymbolsEnd(top.production);
+      continue;
+    }
+
+    int nonterminal = top.nonterminal;
+    stack.pop_back();
+    state[nonterminal] = kFinished;
+    if (nonterminal == start || rule.length != 1 || recursive[nonterminal]) continue;
+    vector<int> body;
+    appendInlined(grammar, rule.start, inlinable, bodies, body);
+    if ((int) body.size() > kMaxInlineSymbols) continue;
+    inlinable[nonterminal] = true;
+    bodies[nonterminal].swap(body);
+  }
+}
+
+/**
+ * Function: optimizeGrammar
+ * -------------------------
+ * The nonterminals still in use are found from the start symbol outward
+ * as their productions are written, so only the live ones are ever
+ * handed to the builder.  The builder keeps views of the names and chunks
+ * it interns, so they're kept in a deque, which never moves its strings.
+ * Every rule is given its productions' probabilities as weights, which
+ * rebuilds the same alias table for a weighted rule and a uniform one
+ * for the rest.
+ */
+
+bool optimizeGrammar(const Grammar& grammar, int start, GrammarBuilder& builder)
+{
+  if (start < 0 || start >= grammar.getNumNonterminals() || grammar.getRule(start).length == 0)
+    return false;
+  vector<bool> inlinable;
+  vector<vector<int> > bodies;
+  findInlinable(grammar, start, inlinable, bodies);
+
+  deque<string> texts;
+  vector<int> newIds(grammar.getNumNonterminals(), -1);
+  texts.push_back(grammar.getName(start));
+  newIds[start] = builder.internNonterminal(texts.back());
+  vector<int> pending(1, start), body;
+  vector<double> probabilities;
+  while (!pending.empty()) {
+    int nonterminal = pending.back();
+    pending.pop_back();
+    const Grammar::Span& rule = grammar.getRule(nonterminal);
+    grammar.getProductionProbabilities(nonterminal, probabilities);
+    builder.beginDefinition(newIds[nonterminal]);
+    for (int i = 0; i < rule.length; i++) {
+      builder.beginProduction(probabilities[i]);
+      body.clear();
+      appendInlined(grammar, rule.start + i, inlinable, bodies, body);
+      for (size_t j = 0; j < body.size(); ) {
+        int symbol = body[j];
+        if (!isText(grammar, symbol)) {
+          if (newIds[symbol] == -1) {
+            texts.push_back(grammar.getName(symbol));
+            newIds[symbol] = builder.internNonterminal(texts.back());
+            pending.push_back(symbol);
+          }
+          builder.addSymbol(newIds[symbol]);
+          j++;
+          continue;
+        }
+        string chunk = getText(grammar, symbol);
+        int numTokens = grammar.getTokenCount(symbol);
+        for (j++; j < body.size() && isText(grammar, body[j]); j++) {
+          chunk += ' ' + getText(grammar, body[j]);
+          numTokens += grammar.getTokenCount(body[j]);
+        }
+        texts.push_back(chunk);
+        builder.addSymbol(builder.internTerminal(texts.back(), numTokens));
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,59 @@
+#ifndef __grammar_optimizer__
+#define __grammar_optimizer__
+
+/**
+ * File: grammar-optimizer.h
+ * -------------------------
+ * Declares the grammar optimizer, which rewrites a compiled Grammar into
+ * an equivalent one that's cheaper to expand:
+ *
+ *    inlining:  a nonterminal with a single production always expands
+ *               the same way, so every use of it is replaced by that
+ *               production's symbols and its random draw disappears.
+ *               Recursive rules are never inlined, and neither are
+ *               productions longer than kMaxInlineSymbols, so the
+ *               grammar can't blow up.
+ *    chunking:  a run of adjacent terminals is always appended as is,
+ *               so it's folded into a single terminal whose text is the
+ *               run joined by spaces.  Undefined nonterminals, which
+ *               expand to their own names, are folded in the same way.
+ *               The chunk records how many tokens it holds (see
+ *               Grammar::getTokenCount), so token limits and lengths
+ *               still count every one of them.
+ *    pruning:   nonterminals that are no longer reachable from the start
+ *               symbol once everything's inlined are dropped.
+ *
+ * Each remaining choice is made among the same productions with the same
+ * probabilities, and every terminal comes out the same, so the optimized
+ * grammar generates exactly the same distribution of sentences.  It
+ * doesn't reproduce the same sentences for a given seed, though, since
+ * it makes fewer draws.
+ */
+
+#include "grammar.h"
+#include "grammar-builder.h"
+
+/**
+ * Constant: kMaxInlineSymbols
+ * ---------------------------
+ * The longest production (counting each terminal, before chunking) that
+ * is inlined into the productions using it.
+ */
+
+static const int kMaxInlineSymbols = 32;
+
+/**
+ * Function: optimizeGrammar
+ * -------------------------
+ * Hands the optimized form of the specified grammar to the specified
+ * builder, which must be empty.
+ *
+ * @param grammar the grammar being optimized.
+ * @param start the ID of the start symbol, which keeps its name.
+ * @return false if the start symbol isn't defined, in which case there's
+ *         nothing to optimize and the builder is left untouched.
+ */
+
+bool optimizeGrammar(const Grammar& grammar, int start, GrammarBuilder& builder);
+
+#endif // ! __grammar_optimizer__
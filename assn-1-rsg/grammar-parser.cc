@@ -0,0 +1,119 @@
+/**
+ * File: grammar-parser.cc
+ * -----------------------
+ * Provides the implementation of the text grammar parser.
+ */
+
+#include "grammar-parser.h"
+#include "production.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * Class: scanner
+ * --------------
+ * A cursor over the mapped file.  Whitespace is what operator>> skips
+ * (space, \t, \n, \v, \f and \r), tested directly rather than through
+ * isspace and the locale.  Skipping to the next '{' or the end
+ * of a line goes through memchr, which the C library vectorizes.
+ */
+
+class scanner {
+ public:
+  scanner(const char *begin, const char *end) : curr(begin), end(end) {}
+
+  bool atEnd() const { return curr == end; }
+  char peek() const { return *curr; }
+  void advance() { curr++; }
+
+  bool skipTo(char ch)
+  {
+    const char *found = (const char *) memchr(curr, ch, end - curr);
+    curr = (found == NULL) ? end : found;
+    return found != NULL;
+  }
+
+  void skipLine() { if (skipTo('\n')) curr++; }
+
+  string_view nextToken()
+  {
+    while (curr != end && isWhitespace(*curr)) curr++;
+    const char *start = curr;
+    while (curr != end && !isWhitespace(*curr)) curr++;
+    return string_view(start, curr - start);
+  }
+
+ private:
+  const char *curr;
+  const char *end;
+
+  static bool isWhitespace(char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); }
+};
+
+/**
+ * Function: parseGrammar
+ * ----------------------
+ * Mirrors the legacy parser step for step.  Text up to each '{' is
+ * ignored.  The first token after the '{' names the nonterminal, and the
+ * rest of that line is ignored.  Then, until a line begins with '}', each
+ * production is read a token at a time up to a ";" token, with an optional
+ * leading [w] weight, and the rest of its line is ignored.
+ */
+
+static void parseGrammar(scanner& in, GrammarBuilder& builder)
+{
+  while (in.skipTo('{')) {
+    in.advance();
+    string_view name = in.nextToken();
+    if (name.empty()) return;
+    builder.beginDefinition(builder.internNonterminal(name));
+    in.skipLine();
+
+    while (!in.atEnd() && in.peek() != '}') {
+      string_view token = in.nextToken();
+      double weight = 1;
+      if (Production::parseWeight(token, weight)) token = in.nextToken();
+      builder.beginProduction(weight);
+      while (!token.empty() && token != ";") {
+        builder.addSymbol(builder.intern(token));
+        token = in.nextToken();
+      }
+      in.skipLine();
+    }
+    if (!in.atEnd()) in.advance();
+  }
+}
+
+/**
+ * Function: parseGrammarFile
+ * --------------------------
+ * The file is unmapped once it's been parsed, which is fine since the
+ * builder only looks at the views while tokens are being interned.
+ */
+
+bool parseGrammarFile(const string& file, GrammarBuilder& builder)
+{
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1) return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return false;
+  }
+  if (info.st_size == 0) {
+    close(fd);
+    return true;
+  }
+  void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) return false;
+  madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+  const char *begin = (const char *) mapped;
+  scanner in(begin, begin + info.st_size);
+  parseGrammar(in, builder);
+  munmap(mapped, info.st_size);
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef __grammar_parser__
+#define __grammar_parser__
+
+/**
+ * File: grammar-parser.h
+ * ----------------------
+ * Declares the text grammar parser, which maps a .g file into memory and
+ * tokenizes it in a single linear pass.  Tokens are string_views into the
+ * mapping and go straight to a GrammarBuilder, so no string, Production or
+ * Definition is ever built.  The grammars accepted, and the way stray text
+ * between definitions is skipped, are exactly what readGrammar and the
+ * Definition and Production constructors accept.
+ */
+
+#include "grammar-builder.h"
+#include <string>
+using namespace std;
+
+/**
+ * Function: parseGrammarFile
+ * --------------------------
+ * Parses the specified text grammar into the specified builder.  The file
+ * is unmapped before this returns, so the builder can be built afterwards
+ * but mustn't be handed any more tokens.
+ *
+ * @param file the path to the .g file.
+ * @param builder the builder the definitions are handed to.
+ * @return false if and only if the file couldn't be opened or mapped.
+ */
+
+bool parseGrammarFile(const string& file, GrammarBuilder& builder);
+
+#endif // ! __grammar_parser__
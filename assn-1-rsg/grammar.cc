@@ -0,0 +1,202 @@
+/**
+ * File: grammar.cc
+ * ----------------
+ * Provides the implementation of the Grammar class, which
+ * compiles grammars into flat arrays of integer symbol IDs,
+ * and saves and loads those arrays as a single binary image.
+ */
+
+#include "grammar.h"
+#include "grammar-builder.h"
+#include "grammar-image.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+Grammar::Grammar(const GrammarBuilder& builder) : mapping(NULL), valid(false)
+{
+  builder.build(ownedImage);
+  valid = attach(ownedImage.data(), ownedImage.size());
+}
+
+/**
+ * Constructor: Grammar
+ * --------------------
+ * The file is mapped read-only and privately, so the page cache backs
+ * the image and nothing is copied.
+ */
+
+Grammar::Grammar(const string& imageFile) : mapping(NULL), valid(false)
+{
+  int fd = open(imageFile.c_str(), O_RDONLY);
+  if (fd == -1) return;
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      mapping = mapped;
+      imageSize = info.st_size;
+      valid = attach((const char *) mapped, info.st_size);
+    }
+  }
+  close(fd);
+}
+
+Grammar::~Grammar()
+{
+  if (mapping != NULL) munmap(mapping, imageSize);
+}
+
+bool Grammar::save(const string& imageFile) const
+{
+  if (!valid) return false;
+  int fd = open(imageFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) return false;
+  size_t written = 0;
+  while (written < imageSize) {
+    ssize_t count = write(fd, image + written, imageSize - written);
+    if (count <= 0) break;
+    written += count;
+  }
+  return close(fd) == 0 && written == imageSize;
+}
+
+bool Grammar::isImageFile(const string& file)
+{
+  char magic[sizeof(kGrammarMagic)];
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1) return false;
+  bool isImage = read(fd, magic, sizeof(magic)) == sizeof(magic) &&
+                 memcmp(magic, kGrammarMagic, sizeof(magic)) == 0;
+  close(fd);
+  return isImage;
+}
+
+/**
+ * Functions: sectionFits, spansFit
+ * --------------------------------
+ * Confirm that an array of count elements at the specified offset lies
+ * within the image and is aligned, and that each of count spans
+ * delimits a run within [0, limit).
+ */
+
+static bool sectionFits(uint32_t offset, uint32_t count, size_t elementSize, size_t imageSize)
+{
+  return offset % 4 == 0 && offset >= sizeof(grammarImageHeader) &&
+         (uint64_t) offset + (uint64_t) count * elementSize <= imageSize;
+}
+
+static bool spansFit(const Grammar::Span *spans, uint32_t count, uint32_t limit)
+{
+  for (uint32_t i = 0; i < count; i++)
+    if (spans[i].start < 0 || spans[i].length < 0 ||
+        (uint64_t) spans[i].start + (uint64_t) spans[i].length > limit) return false;
+  return true;
+}
+
+/**
+ * Method: attach
+ * --------------
+ * Validates the specified image and points the Grammar's views into it.
+ * Validation reads the whole image once, but it's a handful of comparisons
+ * per entry with no parsing and no allocation.  Every span, symbol and
+ * alias is bounds checked, and every alias must stay within its own rule,
+ * so nothing the Expander does with a valid image can index outside of it
+ * or pick another rule's production.
+ */
+
+bool Grammar::attach(const char *image, size_t imageSize)
+{
+  this->image = image;
+  this->imageSize = imageSize;
+  grammarImageHeader header;
+  if (imageSize < sizeof(header)) return false;
+  memcpy(&header, image, sizeof(header));
+  if (memcmp(header.magic, kGrammarMagic, sizeof(kGrammarMagic)) != 0 ||
+      header.byteOrderMark != kGrammarByteOrderMark || header.version != kGrammarFormatVersion ||
+      header.imageSize != imageSize || header.numNonterminals > INT32_MAX ||
+      header.numProductions > INT32_MAX || header.numTerminals > INT32_MAX) return false;
+
+  if (!sectionFits(header.rulesOffset, header.numNonterminals, sizeof(Span), imageSize) ||
+      !sectionFits(header.productionsOffset, header.numProductions, sizeof(Span), imageSize) ||
+      !sectionFits(header.symbolsOffset, header.numSymbols, sizeof(int), imageSize) ||
+      !sectionFits(header.terminalsOffset, header.numTerminals, sizeof(Span), imageSize) ||
+      !sectionFits(header.namesOffset, header.numNonterminals, sizeof(Span), imageSize) ||
+      !sectionFits(header.weightedOffset, header.numNonterminals, 1, imageSize) ||
+      !sectionFits(header.thresholdsOffset, header.numProductions, sizeof(uint32_t), imageSize) ||
+      !sectionFits(header.aliasesOffset, header.numProductions, sizeof(int), imageSize) ||
+      !sectionFits(header.tokenCountsOffset, header.numTerminals, sizeof(int), imageSize) ||
+      !sectionFits(header.textOffset, header.textSize, 1, imageSize)) return false;
+
+  rules = (const Span *) (image + header.rulesOffset);
+  productions = (const Span *) (image + header.productionsOffset);
+  symbols = (const int *) (image + header.symbolsOffset);
+  terminals = (const Span *) (image + header.terminalsOffset);
+  names = (const Span *) (image + header.namesOffset);
+  weighted = (const unsigned char *) (image + header.weightedOffset);
+  thresholds = (const uint32_t *) (image + header.thresholdsOffset);
+  aliases = (const int *) (image + header.aliasesOffset);
+  tokenCounts = (const int *) (image + header.tokenCountsOffset);
+  text = image + header.textOffset;
+  numNonterminals = header.numNonterminals;
+  numProductions = header.numProductions;
+  numTerminals = header.numTerminals;
+
+  if (!spansFit(rules, numNonterminals, numProductions) ||
+      !spansFit(productions, numProductions, header.numSymbols) ||
+      !spansFit(terminals, numTerminals, header.textSize) ||
+      !spansFit(names, numNonterminals, header.textSize)) return false;
+  for (uint32_t i = 0; i < header.numSymbols; i++) {
+    int symbol = symbols[i];
+    if (isNonterminal(symbol) ? symbol >= numNonterminals : getTerminalId(symbol) >= numTerminals)
+      return false;
+  }
+  for (int i = 0; i < numProductions; i++)
+    if (aliases[i] < 0 || aliases[i] >= numProductions) return false;
+  for (int nonterminal = 0; nonterminal < numNonterminals; nonterminal++) {
+    const Span& rule = rules[nonterminal];
+    for (int production = rule.start; production < rule.start + rule.length; production++)
+      if (aliases[production] < rule.start || aliases[production] >= rule.start + rule.length) return false;
+  }
+  for (int i = 0; i < numTerminals; i++)
+    if (tokenCounts[i] < 1) return false;
+  return true;
+}
+
+/**
+ * Method: getProductionProbabilities
+ * ----------------------------------
+ * Each of the n columns is chosen with probability 1/n, and hands
+ * threshold / kOne of that to its own production and the rest to its alias.
+ */
+
+void Grammar::getProductionProbabilities(int nonterminal, vector<double>& probabilities) const
+{
+  const Span& rule = rules[nonterminal];
+  probabilities.assign(rule.length, rule.length == 0 ? 0 : 1.0 / rule.length);
+  if (!weighted[nonterminal]) return;
+  for (int i = 0; i < rule.length; i++) {
+    double kept = (double) thresholds[rule.start + i] / AliasTable::kOne;
+    probabilities[i] = kept / rule.length;
+  }
+  for (int i = 0; i < rule.length; i++) {
+    double kept = (double) thresholds[rule.start + i] / AliasTable::kOne;
+    int alias = aliases[rule.start + i] - rule.start;
+    if (alias >= 0 && alias < rule.length) probabilities[alias] += (1 - kept) / rule.length;
+  }
+}
+
+int Grammar::getNonterminal(const string& name) const
+{
+  for (int i = 0; i < numNonterminals; i++)
+    if (name.compare(0, string::npos, text + names[i].start, names[i].length) == 0)
+      return i;
+  return -1;
+}
+
+string Grammar::getName(int nonterminal) const
+{
+  return string(text + names[nonterminal].start, names[nonterminal].length);
+}
@@ -0,0 +1,280 @@
+#ifndef __grammar__
+#define __grammar__
+
+/**
+ * File: grammar.h
+ * ---------------
+ * Defines the Grammar class, which is the compiled form of a grammar.
+ * Compiling interns every nonterminal and every terminal into an integer
+ * ID, so that expanding a sentence is nothing more than array indexing:
+ * no string hashing and no string comparisons.
+ *
+ * The compiled grammar is a handful of flat arrays:
+ *
+ *    rules:       one entry per nonterminal, delimiting its
+ *                 productions within the productions array.
+ *    productions: one entry per production, delimiting its
+ *                 symbols within the symbol pool.
+ *    symbols:     every production's symbols, back to back, in one
+ *                 contiguous pool.  A symbol >= 0 is a nonterminal ID,
+ *                 and a symbol < 0 is the terminal ID ~symbol.
+ *    terminals:   one entry per distinct terminal, delimiting its
+ *                 characters within the text arena.
+ *    text:        the characters of every terminal and every nonterminal
+ *                 name, back to back, in a single string arena.
+ *    thresholds,
+ *    aliases:     one entry per production, holding the alias table
+ *                 column for that production (see alias-table.h), with
+ *                 aliases given as production IDs.  Only consulted for
+ *                 nonterminals whose productions have unequal weights,
+ *                 which weighted says.
+ *    tokenCounts: one entry per terminal, holding the number of tokens
+ *                 it stands for: 1, unless it's a chunk of several
+ *                 folded together by the optimizer.
+ *
+ * A token is a nonterminal if and only if it starts with '<' and ends
+ * with '>'.  Nonterminals that are used but never defined are given an
+ * ID with no productions.
+ *
+ * All of the arrays live in one contiguous image (see grammar-image.h),
+ * and the Grammar itself is just a set of views into it.  A Grammar
+ * laid out by a GrammarBuilder owns its image, and one loaded from an
+ * .rsgc file maps the file and uses the image in place.
+ */
+
+#include "alias-table.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+class GrammarBuilder;
+
+class Grammar {
+
+ public:
+
+  /**
+   * Convenience struct: Span
+   * ------------------------
+   * Identifies the contiguous run of entries [start, start + length)
+   * within one of the grammar's arrays.
+   */
+
+  struct Span {
+    int start;
+    int length;
+  };
+
+  /**
+   * Constructor: Grammar
+   * --------------------
+   * Lays out the grammar accumulated by the specified builder (see
+   * grammar-builder.h), which is how the text grammar parser produces one.
+   */
+
+  Grammar(const GrammarBuilder& builder);
+
+  /**
+   * Constructor: Grammar
+   * --------------------
+   * Maps the specified image file (as written by save) into memory and
+   * uses it in place.  The image's header and every index within it are
+   * checked, so a truncated or corrupt file makes for a Grammar that
+   * isn't good rather than a crash.
+   *
+   * @param imageFile the path to the .rsgc file.
+   */
+
+  Grammar(const string& imageFile);
+
+  /**
+   * Destructor: ~Grammar
+   * --------------------
+   * Releases the image, unmapping it if it was loaded from a file.
+   */
+
+  ~Grammar();
+
+  /**
+   * Method: good
+   * ------------
+   * Returns true if and only if the Grammar was compiled, or its image
+   * was loaded and found to be well formed.
+   */
+
+  bool good() const { return valid; }
+
+  /**
+   * Method: save
+   * ------------
+   * Writes the Grammar's image to the specified file.
+   *
+   * @return true if and only if the whole image was written.
+   */
+
+  bool save(const string& imageFile) const;
+
+  /**
+   * Method: isImageFile
+   * -------------------
+   * Returns true if and only if the specified file begins like
+   * a grammar image rather than a text grammar.
+   */
+
+  static bool isImageFile(const string& file);
+
+  /**
+   * Predicates: isTerminal, isNonterminal
+   * -------------------------------------
+   * Classify a symbol drawn from a production.
+   */
+
+  static bool isTerminal(int symbol) { return symbol < 0; }
+  static bool isNonterminal(int symbol) { return symbol >= 0; }
+  static int getTerminalId(int symbol) { return ~symbol; }
+
+  /**
+   * Methods: getNumNonterminals, getNumTerminals, getNumProductions
+   * ---------------------------------------------------------------
+   * Self-explanatory.
+   */
+
+  int getNumNonterminals() const { return numNonterminals; }
+  int getNumTerminals() const { return numTerminals; }
+  int getNumProductions() const { return numProductions; }
+
+  /**
+   * Method: getNonterminal
+   * ----------------------
+   * Returns the ID of the specified nonterminal (with the '<' and '>'),
+   * or -1 if the grammar never mentions it.  This is a linear search and
+   * is intended for setup (finding <start>), not for expansion.
+   */
+
+  int getNonterminal(const string& name) const;
+
+  /**
+   * Method: getName
+   * ---------------
+   * Returns the name of the specified nonterminal, '<' and '>' included,
+   * either as a copy or as a view into the grammar's text.
+   */
+
+  string getName(int nonterminal) const;
+  string_view getNameView(int nonterminal) const
+    { return string_view(text + names[nonterminal].start, names[nonterminal].length); }
+
+  /**
+   * Method: getRule
+   * ---------------
+   * Returns the span of productions belonging to the specified
+   * nonterminal.  The length is 0 if the nonterminal is never defined.
+   */
+
+  const Span& getRule(int nonterminal) const { return rules[nonterminal]; }
+
+  /**
+   * Method: getProductionProbabilities
+   * ----------------------------------
+   * Fills in the probability with which getRandomProduction chooses each
+   * of the specified nonterminal's productions, in order.  The
+   * probabilities are recovered from the alias table, so they're exactly
+   * the ones sampled from.
+   */
+
+  void getProductionProbabilities(int nonterminal, vector<double>& probabilities) const;
+
+  /**
+   * Method: getRandomProduction
+   * ---------------------------
+   * Returns the ID of one of the specified nonterminal's productions,
+   * chosen with probability proportional to its weight.  Nonterminals with
+   * equally weighted productions consume exactly one draw of
+   * getRandomInteger(0, n - 1), just as they always have.  The nonterminal
+   * must have at least one production.
+   */
+
+  template <class Generator>
+  int getRandomProduction(int nonterminal, Generator& random) const
+  {
+    const Span& rule = rules[nonterminal];
+    int production = rule.start + random.getRandomInteger(0, rule.length - 1);
+    if (!weighted[nonterminal]) return production;
+    uint32_t coin = random.getRandomInteger(0, AliasTable::kOne - 1);
+    return coin < thresholds[production] ? production : aliases[production];
+  }
+
+  /**
+   * Methods: isWeighted, getThreshold, getAlias
+   * -------------------------------------------
+   * Expose the alias table getRandomProduction samples from, for code that
+   * needs to make exactly the same choices some other way.  getAlias
+   * returns a production ID.
+   */
+
+  bool isWeighted(int nonterminal) const { return weighted[nonterminal]; }
+  uint32_t getThreshold(int production) const { return thresholds[production]; }
+  int getAlias(int production) const { return aliases[production]; }
+
+  /**
+   * Methods: getSymbols, getSymbolsEnd
+   * ----------------------------------
+   * Return the address of the first symbol of the specified production,
+   * or the address just past its last symbol.
+   */
+
+  const int *getSymbols(int production) const { return symbols + productions[production].start; }
+  const int *getSymbolsEnd(int production) const { return getSymbols(production) + productions[production].length; }
+
+  /**
+   * Methods: getText, getTextLength
+   * -------------------------------
+   * Return the characters of the specified terminal (which are not
+   * '\0'-terminated) and the number of them.
+   */
+
+  const char *getText(int terminal) const { return text + terminals[terminal].start; }
+  int getTextLength(int terminal) const { return terminals[terminal].length; }
+
+  /**
+   * Method: getTokenCount
+   * ---------------------
+   * Returns the number of tokens a symbol that expands to text (a terminal
+   * or an undefined nonterminal) stands for.  That's 1, except for a chunk
+   * the optimizer folded a run of terminals into, which counts every one
+   * of them, so lengths and limits are in the same tokens either way.
+   */
+
+  int getTokenCount(int symbol) const { return isTerminal(symbol) ? tokenCounts[getTerminalId(symbol)] : 1; }
+
+ private:
+  const Span *rules;
+  const Span *productions;
+  const int *symbols;
+  const Span *terminals;
+  const Span *names;
+  const unsigned char *weighted;
+  const uint32_t *thresholds;
+  const int *aliases;
+  const int *tokenCounts;
+  const char *text;
+  int numNonterminals;
+  int numProductions;
+  int numTerminals;
+
+  const char *image;
+  size_t imageSize;
+  vector<char> ownedImage;
+  void *mapping;
+  bool valid;
+
+  bool attach(const char *image, size_t imageSize);
+
+  Grammar(const Grammar&);
+  Grammar& operator=(const Grammar&);
+};
+
+#endif // ! __grammar__
@@ -0,0 +1,150 @@
+/**
+ * File: length-table.cc
+ * ---------------------
+ * Provides the implementation of the LengthTable class.  Bit n of a
+ * nonterminal's row is set if it derives n tokens, and bit maxLength - n
+ * of a suffix row is set if the suffix does.
+ */
+
+#include "length-table.h"
+
+static bool testBit(const uint64_t *row, int bit) { return (row[bit >> 6] >> (bit & 63)) & 1; }
+static void setBit(uint64_t *row, int bit) { row[bit >> 6] |= (uint64_t) 1 << (bit & 63); }
+
+/**
+ * Constructor: LengthTable
+ * ------------------------
+ * Only the live nonterminals (reachable, defined, and able to terminate)
+ * get rows, as with the SentenceCounter.  Each length is swept until a
+ * sweep adds nothing new: each sweep recomputes every suffix from the
+ * rows as they stand, so a nonterminal that only derives n tokens
+ * through another that a previous sweep just found is picked up by the
+ * next one.  A sweep can only add bits, so this ends, and the final
+ * sweep leaves every suffix consistent with the finished rows.
+ */
+
+LengthTable::LengthTable(const Grammar& grammar, const GrammarAnalysis& analysis, int maxLength) :
+  grammar(grammar), maxLength(maxLength), numWords((maxLength + 64) / 64)
+{
+  int numNonterminals = grammar.getNumNonterminals();
+  vector<int> live;
+  liveIndex.assign(numNonterminals, -1);
+  suffixStart.assign(grammar.getNumProductions(), -1);
+  weights.assign(grammar.getNumProductions(), 0);
+  long long numSuffixWords = 0;
+  vector<double> probabilities;
+  for (int nonterminal = 0; nonterminal < numNonterminals; nonterminal++) {
+    if (!analysis.isReachable(nonterminal) || !analysis.isDefined(nonterminal) ||
+        !analysis.canTerminate(nonterminal)) continue;
+    liveIndex[nonterminal] = live.size();
+    live.push_back(nonterminal);
+    const Grammar::Span& rule = grammar.getRule(nonterminal);
+    grammar.getProductionProbabilities(nonterminal, probabilities);
+    for (int production = rule.start; production < rule.start + rule.length; production++) {
+      weights[production] = probabilities[production - rule.start];
+      suffixStart[production] = numSuffixWords;
+      numSuffixWords += (long long) (grammar.getSymbolsEnd(production) - grammar.getSymbols(production)) * numWords;
+    }
+  }
+
+  emptyRow.assign(numWords, 0);
+  emptySuffixRow.assign(numWords, 0);
+  setBit(&emptySuffixRow[0], maxLength);
+  rows.assign(live.size() * numWords, 0);
+  suffixRows.assign(numSuffixWords, 0);
+  for (int length = 0; length <= maxLength; length++) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (size_t k = 0; k < live.size(); k++) {
+        const Grammar::Span& rule = grammar.getRule(live[k]);
+        uint64_t *row = &rows[k * numWords];
+        for (int production = rule.start; production < rule.start + rule.length; production++) {
+          const int *symbols = grammar.getSymbols(production);
+          for (int i = grammar.getSymbolsEnd(production) - symbols - 1; i >= 0; i--) {
+            bool reachable;
+            if (isText(symbols[i])) {
+              int numTokens = grammar.getTokenCount(symbols[i]);
+              reachable = length >= numTokens && hasSuffix(production, i + 1, length - numTokens);
+            } else {
+              reachable = countSplits(production, i, length) > 0;
+            }
+            if (reachable) setBit(suffixRowAt(production, i), maxLength - length);
+          }
+          if (!testBit(row, length) && hasSuffix(production, 0, length)) {
+            setBit(row, length);
+            changed = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+bool LengthTable::derives(int symbol, int length) const
+{
+  if (isText(symbol)) return length == grammar.getTokenCount(symbol);
+  return length >= 0 && length <= maxLength && testBit(getRow(symbol), length);
+}
+
+const uint64_t *LengthTable::getRow(int symbol) const
+{
+  if (liveIndex[symbol] == -1) return &emptyRow[0];
+  return &rows[liveIndex[symbol] * numWords];
+}
+
+const uint64_t *LengthTable::getSuffixRow(int production, int i) const
+{
+  if (i == grammar.getSymbolsEnd(production) - grammar.getSymbols(production)) return &emptySuffixRow[0];
+  return &suffixRows[suffixStart[production] + (long long) i * numWords];
+}
+
+bool LengthTable::hasSuffix(int production, int i, int length) const
+{
+  return testBit(getSuffixRow(production, i), maxLength - length);
+}
+
+/**
+ * Method: getSplitWord
+ * --------------------
+ * Returns the split candidates j in [64 * word, 64 * word + 63] as a
+ * bitmask: those where symbol i derives j tokens and the symbols after it
+ * derive length - j.  The second condition is bit maxLength - length + j
+ * of the reversed suffix row, so it's a 64-bit window of that row starting
+ * at an arbitrary bit.  Bits past maxLength are never set, so candidates
+ * past length drop out on their own.
+ */
+
+uint64_t LengthTable::getSplitWord(int production, int i, int length, int word) const
+{
+  const uint64_t *row = getRow(grammar.getSymbols(production)[i]);
+  const uint64_t *suffix = getSuffixRow(production, i + 1);
+  int offset = maxLength - length + 64 * word;
+  int index = offset >> 6, shift = offset & 63;
+  if (index >= numWords) return 0;
+  uint64_t window = suffix[index] >> shift;
+  if (shift != 0 && index + 1 < numWords) window |= suffix[index + 1] << (64 - shift);
+  return row[word] & window;
+}
+
+int LengthTable::countSplits(int production, int i, int length) const
+{
+  int numSplits = 0;
+  for (int word = 0; word <= length >> 6; word++)
+    numSplits += __builtin_popcountll(getSplitWord(production, i, length, word));
+  return numSplits;
+}
+
+int LengthTable::selectSplit(int production, int i, int length, int chosen) const
+{
+  for (int word = 0; ; word++) {
+    uint64_t candidates = getSplitWord(production, i, length, word);
+    int numCandidates = __builtin_popcountll(candidates);
+    if (chosen >= numCandidates) {
+      chosen -= numCandidates;
+      continue;
+    }
+    for (; chosen > 0; chosen--) candidates &= candidates - 1;
+    return 64 * word + __builtin_ctzll(candidates);
+  }
+}
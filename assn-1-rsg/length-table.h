@@ -0,0 +1,143 @@
+#ifndef __length_table__
+#define __length_table__
+
+/**
+ * File: length-table.h
+ * --------------------
+ * Defines the LengthTable class, which records which lengths (in tokens)
+ * each nonterminal can expand to, up to a bound, so that sentences of an
+ * exact length can be generated directly instead of by rejection.  It's
+ * the yes-or-no version of the SentenceCounter's tables (see
+ * sentence-counter.h): with derives(A, n) true if A has an expansion of
+ * exactly n tokens,
+ *
+ *    derives(A, n) = some production p of A has suffix(p, 0, n),
+ *    suffix(p, i, n) = derives(s_i, j) and suffix(p, i + 1, n - j) for some j,
+ *
+ * where a terminal (or undefined nonterminal) derives just its token count
+ * (see Grammar::getTokenCount).  The table is filled one length at a time,
+ * sweeping each length until it stops changing, since a yes-or-no table
+ * is unaffected by the cycles that make counts infinite.
+ *
+ * Each row is a bitset over lengths.  The suffix rows are stored
+ * reversed, so that the split candidates j for a symbol, those with
+ * derives(s_i, j) and suffix(p, i + 1, n - j), are the AND of one row
+ * with a shifted window of another, 64 lengths per word.  Generating a
+ * sentence of n tokens is then a top down walk like the SentenceCounter's,
+ * with each split chosen among the candidates in O(n / 64) time, and no
+ * choice ever leads to a dead end.
+ */
+
+#include "grammar.h"
+#include "grammar-analysis.h"
+#include <stdint.h>
+#include <limits.h>
+#include <vector>
+using namespace std;
+
+class LengthTable {
+
+ public:
+
+  /**
+   * Constructor: LengthTable
+   * ------------------------
+   * Works out which lengths up to maxLength every nonterminal that the
+   * analysis found reachable, defined and able to terminate can expand
+   * to.  The grammar must outlive the table.
+   */
+
+  LengthTable(const Grammar& grammar, const GrammarAnalysis& analysis, int maxLength);
+
+  int getMaxLength() const { return maxLength; }
+
+  /**
+   * Method: derives
+   * ---------------
+   * Returns true if and only if the specified symbol can expand to
+   * exactly the specified number of tokens.
+   */
+
+  bool derives(int symbol, int length) const;
+
+  /**
+   * Methods: chooseLength, chooseProduction, chooseSplit
+   * ----------------------------------------------------
+   * The steps of generating an expansion of a given length, top down.
+   * chooseLength picks a length in [minLength, maxLength] that the
+   * nonterminal can expand to, uniformly, or returns -1 if there's none.
+   * chooseProduction picks one of the nonterminal's productions that can
+   * expand to length tokens, with probability proportional to its weight
+   * among those.  chooseSplit picks, uniformly among the choices that
+   * leave the rest of the production able to finish, how many of the
+   * length tokens that symbols i onward account for come from symbol i.
+   */
+
+  template <class Generator>
+  int chooseLength(int nonterminal, int minLength, int maxLength, Generator& random) const
+  {
+    int numLengths = 0;
+    for (int length = minLength; length <= maxLength; length++)
+      if (derives(nonterminal, length)) numLengths++;
+    if (numLengths == 0) return -1;
+    int chosen = random.getRandomInteger(0, numLengths - 1);
+    for (int length = minLength; ; length++)
+      if (derives(nonterminal, length) && chosen-- == 0) return length;
+  }
+
+  template <class Generator>
+  int chooseProduction(int nonterminal, int length, Generator& random) const
+  {
+    const Grammar::Span& rule = grammar.getRule(nonterminal);
+    int numProductions = 0;
+    double total = 0;
+    for (int production = rule.start; production < rule.start + rule.length; production++) {
+      if (!hasSuffix(production, 0, length)) continue;
+      numProductions++;
+      total += weights[production];
+    }
+    int chosen = 0;
+    double point = 0;
+    if (grammar.isWeighted(nonterminal)) point = total * random.getRandomInteger(0, INT_MAX) / (INT_MAX + 1.0);
+    else chosen = random.getRandomInteger(0, numProductions - 1);
+    int production = rule.start;
+    for (;; production++) {
+      if (!hasSuffix(production, 0, length)) continue;
+      if (--numProductions == 0) break;
+      if (grammar.isWeighted(nonterminal) ? point < weights[production] : chosen == 0) break;
+      point -= weights[production];
+      chosen--;
+    }
+    return production;
+  }
+
+  template <class Generator>
+  int chooseSplit(int production, int i, int length, Generator& random) const
+  {
+    int symbol = grammar.getSymbols(production)[i];
+    if (isText(symbol)) return grammar.getTokenCount(symbol);
+    return selectSplit(production, i, length, random.getRandomInteger(0, countSplits(production, i, length) - 1));
+  }
+
+ private:
+  const Grammar& grammar;
+  int maxLength;
+  int numWords;
+  vector<int> liveIndex;
+  vector<uint64_t> rows;
+  vector<long long> suffixStart;
+  vector<uint64_t> suffixRows;
+  vector<uint64_t> emptyRow, emptySuffixRow;
+  vector<double> weights;
+
+  bool isText(int symbol) const { return Grammar::isTerminal(symbol) || grammar.getRule(symbol).length == 0; }
+  const uint64_t *getRow(int symbol) const;
+  const uint64_t *getSuffixRow(int production, int i) const;
+  uint64_t *suffixRowAt(int production, int i) { return &suffixRows[suffixStart[production] + (long long) i * numWords]; }
+  bool hasSuffix(int production, int i, int length) const;
+  uint64_t getSplitWord(int production, int i, int length, int word) const;
+  int countSplits(int production, int i, int length) const;
+  int selectSplit(int production, int i, int length, int chosen) const;
+};
+
+#endif // ! __length_table__
@@ -0,0 +1,62 @@
+/**
+ * File: output-buffer.cc
+ * ----------------------
+ * Provides the implementation of the OutputBuffer class.
+ */
+
+#include "output-buffer.h"
+#include <errno.h>
+#include <unistd.h>
+
+OutputBuffer::OutputBuffer(int fd, size_t flushThreshold) :
+  fd(fd), flushThreshold(flushThreshold), size(0), bytesWritten(0), failed(false)
+{
+  capacity = flushThreshold + flushThreshold / 4 + 64;
+  data = new char[capacity];
+}
+
+OutputBuffer::~OutputBuffer()
+{
+  flush();
+  delete[] data;
+}
+
+/**
+ * Method: flush
+ * -------------
+ * write may accept fewer bytes than it was offered (pipes and sockets
+ * commonly do) or be interrupted by a signal, so it's called until
+ * everything's gone.  After a failure the buffered text is discarded,
+ * which keeps a dead pipe from growing the buffer without bound.
+ */
+
+bool OutputBuffer::flush()
+{
+  size_t written = 0;
+  while (written < size && !failed) {
+    ssize_t count = write(fd, data + written, size - written);
+    if (count > 0) written += count;
+    else if (count < 0 && errno != EINTR) failed = true;
+  }
+  bytesWritten += written;
+  size = 0;
+  return !failed;
+}
+
+/**
+ * Method: grow
+ * ------------
+ * Doubles the capacity until it's at least minCapacity.  The buffer is
+ * allocated with new rather than malloc so the allocation counters (see
+ * allocation-counter.h) see it; it only grows while warming up, so
+ * copying instead of reallocating in place costs nothing that matters.
+ */
+
+void OutputBuffer::grow(size_t minCapacity)
+{
+  while (capacity < minCapacity) capacity *= 2;
+  char *grown = new char[capacity];
+  memcpy(grown, data, size);
+  delete[] data;
+  data = grown;
+}
@@ -0,0 +1,150 @@
+#ifndef __output_buffer__
+#define __output_buffer__
+
+/**
+ * File: output-buffer.h
+ * ---------------------
+ * Defines the OutputBuffer class, which collects generated text in one
+ * large, reusable block of memory and hands it to the operating system
+ * with a few big write calls rather than many small ones.  The buffer is
+ * only flushed when the client says it's at a sentence boundary, so a
+ * sentence is never split across two writes, and the block simply grows
+ * if a single sentence is larger than the flush threshold.
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+class OutputBuffer {
+
+ public:
+
+  /**
+   * Constructor: OutputBuffer
+   * -------------------------
+   * Constructs an empty OutputBuffer that writes to the specified file
+   * descriptor once it holds at least flushThreshold bytes.  The file
+   * descriptor isn't closed by the OutputBuffer.
+   *
+   * @param fd the file descriptor being written to.
+   * @param flushThreshold the number of buffered bytes that warrants a write.
+   */
+
+  OutputBuffer(int fd, size_t flushThreshold = 1 << 20);
+
+  /**
+   * Destructor: ~OutputBuffer
+   * -------------------------
+   * Flushes whatever's left and releases the buffer.
+   */
+
+  ~OutputBuffer();
+
+  /**
+   * Methods: append
+   * ---------------
+   * Add the specified characters (or single character) to the end of the
+   * buffer, growing it if necessary.
+   */
+
+  void append(const char *text, size_t length)
+  {
+    if (size + length > capacity) grow(size + length);
+    memcpy(data + size, text, length);
+    size += length;
+  }
+
+  void append(char ch)
+  {
+    if (size == capacity) grow(size + 1);
+    data[size++] = ch;
+  }
+
+  /**
+   * Method: reserve
+   * ---------------
+   * Grows the buffer ahead of time so it can hold at least the specified
+   * number of bytes without reallocating.
+   */
+
+  void reserve(size_t bytes) { if (bytes > capacity) grow(bytes); }
+
+  /**
+   * Method: endLine
+   * ---------------
+   * Terminates the current line, replacing the trailing space the
+   * Expander leaves after the last word if there is one.
+   */
+
+  void endLine()
+  {
+    if (size > 0 && data[size - 1] == ' ') data[size - 1] = '\n';
+    else append('\n');
+  }
+
+  /**
+   * Method: endSentence
+   * -------------------
+   * Informs the buffer that it holds only complete sentences, and flushes
+   * it if it's reached the flush threshold.
+   */
+
+  void endSentence() { if (size >= flushThreshold) flush(); }
+
+  /**
+   * Method: flush
+   * -------------
+   * Writes everything buffered so far and empties the buffer.
+   *
+   * @return false if and only if some write has failed.
+   */
+
+  bool flush();
+
+  /**
+   * Method: discard
+   * ---------------
+   * Empties the buffer without writing anything.
+   */
+
+  void discard() { size = 0; }
+
+  /**
+   * Methods: getData, getSize, truncate
+   * -----------------------------------
+   * Return the bytes buffered (which move whenever the buffer grows) and
+   * how many there are, and drop everything buffered past the first size
+   * of them, which lets a client take back a sentence it has decided not
+   * to keep, provided it hasn't flushed since.
+   */
+
+  const char *getData() const { return data; }
+  size_t getSize() const { return size; }
+  void truncate(size_t size) { this->size = size; }
+
+  /**
+   * Methods: getBytesWritten, fail
+   * ------------------------------
+   * Return the total number of bytes flushed so far, and whether any
+   * write has failed.
+   */
+
+  size_t getBytesWritten() const { return bytesWritten; }
+  bool fail() const { return failed; }
+
+ private:
+  int fd;
+  size_t flushThreshold;
+  char *data;
+  size_t size;
+  size_t capacity;
+  size_t bytesWritten;
+  bool failed;
+
+  void grow(size_t minCapacity);
+
+  OutputBuffer(const OutputBuffer&);
+  OutputBuffer& operator=(const OutputBuffer&);
+};
+
+#endif // ! __output_buffer__
@@ -0,0 +1,107 @@
+#ifndef __philox__
+#define __philox__
+
+/**
+ * File: philox.h
+ * --------------
+ * Defines the PhiloxGenerator class, a counter-based random number
+ * generator built on Philox4x32-10 (Salmon et al., "Parallel Random
+ * Numbers: As Easy as 1, 2, 3").  Rather than advancing a hidden state,
+ * Philox scrambles a 128-bit counter under a 64-bit key, so the nth
+ * number of any stream can be computed directly.  Here the key is the
+ * seed and the counter is (sentence index, draw index), which means the
+ * random choices behind sentence i depend on nothing but the seed and i:
+ * not on the sentences before it, and not on which thread generates it.
+ *
+ * PhiloxGenerator offers the same getRandomInteger as RandomGenerator,
+ * so the Expander can draw from either.
+ */
+
+#include <stdint.h>
+#include <cassert> // for assert macro
+
+class PhiloxGenerator {
+
+ public:
+
+  /**
+   * Constructor: PhiloxGenerator
+   * ----------------------------
+   * Constructs the stream of draws belonging to the specified sentence
+   * of the specified seed's corpus.
+   *
+   * @param seed the seed every sentence of the corpus shares.
+   * @param sentence the index of the sentence within the corpus.
+   */
+
+  PhiloxGenerator(uint64_t seed, uint64_t sentence) :
+    key0(seed), key1(seed >> 32), sentence(sentence), draw(0) {}
+
+  /**
+   * Method: getRandomInteger
+   * ------------------------
+   * Generates an integer drawn uniformly from [low, high], exactly as
+   * RandomGenerator::getRandomInteger does, using Lemire's multiply-shift
+   * method with rejection.
+   */
+
+  int getRandomInteger(int low, int high)
+  {
+    assert(low <= high);
+    uint32_t range = (uint32_t) high - (uint32_t) low + 1;
+    if (range == 0) return (int) next();  // [INT_MIN, INT_MAX]
+    uint64_t product = (uint64_t) next() * range;
+    if ((uint32_t) product < range) {
+      uint32_t threshold = -range % range;
+      while ((uint32_t) product < threshold)
+        product = (uint64_t) next() * range;
+    }
+    return (int) ((uint32_t) low + (uint32_t) (product >> 32));
+  }
+
+  /**
+   * Method: next
+   * ------------
+   * Returns the next 32 random bits of this sentence's stream.  Each
+   * block of Philox output supplies four of them.
+   */
+
+  uint32_t next()
+  {
+    if ((draw & 3) == 0) generateBlock(draw >> 2);
+    return block[draw++ & 3];
+  }
+
+ private:
+  uint32_t key0, key1;
+  uint64_t sentence;
+  uint64_t draw;
+  uint32_t block[4];
+
+  /**
+   * Method: generateBlock
+   * ---------------------
+   * Fills block with Philox4x32-10 of the counter (index, sentence) under
+   * the key (key0, key1).  The output matches the Random123 known-answer
+   * vectors for philox4x32_10.
+   */
+
+  void generateBlock(uint64_t index)
+  {
+    uint32_t counter[4] = { (uint32_t) index, (uint32_t) (index >> 32),
+                            (uint32_t) sentence, (uint32_t) (sentence >> 32) };
+    uint32_t k0 = key0, k1 = key1;
+    for (int round = 0; round < 10; round++) {
+      uint64_t product0 = (uint64_t) 0xD2511F53 * counter[0];
+      uint64_t product1 = (uint64_t) 0xCD9E8D57 * counter[2];
+      uint32_t next[4] = { (uint32_t) (product1 >> 32) ^ counter[1] ^ k0, (uint32_t) product1,
+                           (uint32_t) (product0 >> 32) ^ counter[3] ^ k1, (uint32_t) product0 };
+      for (int i = 0; i < 4; i++) counter[i] = next[i];
+      k0 += 0x9E3779B9;
+      k1 += 0xBB67AE85;
+    }
+    for (int i = 0; i < 4; i++) block[i] = counter[i];
+  }
+};
+
+#endif // ! __philox__
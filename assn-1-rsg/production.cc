@@ -8,6 +8,7 @@
  */
 
 #include "production.h"
+#include <ctype.h>
 
 /**
  * Constructor Implementation: Production
@@ -25,14 +26,23 @@
  *
  * You are more than welcome to update this implementation to do
  * something else if you'd like to.
+ *
+ * A leading [w] token is taken to be the weight; anything else in brackets
+ * (or a bracketed weight anywhere but first) is an ordinary word.
  */
 
-Production::Production(ifstream& infile)  // phrases is constructed, size is 0
+Production::Production(ifstream& infile) : weight(1)  // phrases is constructed, size is 0
 {
+  bool first = true;
   while (true) {
     string token;
     infile >> token;  // ignores whitespace by default
     if (token == ";") break;
+    if (first && parseWeight(token, weight)) {
+      first = false;
+      continue;
+    }
+    first = false;
     phrases.push_back(token);
   }
   
@@ -40,3 +50,31 @@ Production::Production(ifstream& infile)  // phrases is constructed, size is 0
   getline(infile, uselessText); // read everything else as if it's important
   // oh, no it's not.. it's useless.. but we're glad it's been pulled from the stream..
 }
+
+/**
+ * Method: parseWeight
+ * -------------------
+ * strtod can't be handed the view directly, since the token needn't be
+ * followed by a '\0', so the value is accumulated digit by digit.
+ */
+
+bool Production::parseWeight(string_view token, double& weight)
+{
+  if (token.size() < 3 || token.front() != '[' || token.back() != ']') return false;
+  double value = 0, scale = 1;
+  int numDigits = 0, numPoints = 0;
+  for (size_t i = 1; i + 1 < token.size(); i++) {
+    if (isdigit((unsigned char) token[i])) {
+      numDigits++;
+      if (numPoints == 0) value = value * 10 + (token[i] - '0');
+      else value += (token[i] - '0') * (scale /= 10);
+    } else if (token[i] == '.') {
+      numPoints++;
+    } else {
+      return false;
+    }
+  }
+  if (numDigits == 0 || numPoints > 1) return false;
+  weight = value;
+  return true;
+}
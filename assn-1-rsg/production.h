@@ -3,7 +3,9 @@
  * ------------------
  * Defines the abstraction for the Production class, 
  * which encapsulates the functionality needed to store
- * a contiguous list of strings.
+ * a contiguous list of strings.  A Production may also
+ * carry a weight, which makes it more or less likely to
+ * be chosen than its siblings; see the ifstream constructor.
  */
  
 #ifndef __production__
@@ -13,6 +15,7 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 using namespace std;
 
 class Production {
@@ -44,7 +47,7 @@ class Production {
    * have a default constructor.
    */
   
-  Production() {}
+  Production() : weight(1) {}
   
   /**
    * ifstream Constructor: Production
@@ -55,6 +58,11 @@ class Production {
    * Leading whitespace is discarded, the series of terminals and
    * non-terminals are read in until a semicolon is consumed, and
    * the the rest of the data is discarded.
+   *
+   * If the first token has the form [w], where w is a nonnegative
+   * decimal number (as in "[2.5] big yellow flowers ;"), it isn't
+   * a word of the Production but its weight.  Productions without
+   * one have weight 1.
    */
   
   Production(ifstream& infile);
@@ -66,7 +74,28 @@ class Production {
    * a copy of the provided vector.
    */
   
-  Production(const vector<string>& words) : phrases(words) {}
+  Production(const vector<string>& words, double weight = 1) : phrases(words), weight(weight) {}
+
+  /**
+   * Method: getWeight
+   * -----------------
+   * Returns the Production's relative likelihood of being chosen.
+   */
+
+  double getWeight() const { return weight; }
+
+  /**
+   * Method: parseWeight
+   * -------------------
+   * Recognizes a weight token: '[', one or more digits with at most one
+   * decimal point among them, and ']'.
+   *
+   * @param token the token being examined.
+   * @param weight set to the token's value if it's a weight.
+   * @return true if and only if the token is a weight.
+   */
+
+  static bool parseWeight(string_view token, double& weight);
   
   /**
    * Iterators: begin, end
@@ -93,6 +122,7 @@ class Production {
   
  private:
   vector<string> phrases;
+  double weight;
 };
 
 #endif
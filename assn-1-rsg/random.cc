@@ -1,37 +1,68 @@
-#include <time.h>
-#include <stdlib.h>
-#include <limits.h>
-#include <cassert> // for assert macro
+#include <chrono>
+#include <atomic>
 #include "random.h"
+using namespace std;
 
 /**
  * Constructor: RandomGenerator
  * ----------------------------
  * Initializes a RandomGenerator number generator, using 
- * informtaion based on the current time as the seed.
+ * information based on the current time as the seed.
  * This is the traditional way to set the stage for a computer
- * program to use random numbers.
+ * program to use random numbers, except that the time is taken
+ * to the nanosecond rather than to the second, and it's mixed with
+ * a counter so two generators constructed during the same tick differ.
  */
 
 RandomGenerator::RandomGenerator()
 {
-  srand(time(NULL));
+  static atomic<uint64_t> numConstructed(0);
+  uint64_t now = chrono::high_resolution_clock::now().time_since_epoch().count();
+  seed(now ^ (numConstructed++ * 0x9e3779b97f4a7c15ULL));
+}
+
+RandomGenerator::RandomGenerator(uint64_t seed)
+{
+  this->seed(seed);
+}
+
+/**
+ * Method: seed
+ * ------------
+ * Fills the 256 bits of state from a 64-bit seed using splitmix64, as
+ * recommended by xoshiro's authors: similar seeds give unrelated states,
+ * and the state can't come out all zeroes.
+ */
+
+void RandomGenerator::seed(uint64_t seed)
+{
+  for (int i = 0; i < 4; i++) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    state[i] = z ^ (z >> 31);
+  }
 }
 
 /**
- * Method: getRandomInteger
- * ------------------------
- * Returns a seemingly random number between
- * the specified low and high, inclusive.  Based
- * on Eric Roberts' implementation from his
- * CS106A text.
+ * Method: jump
+ * ------------
+ * The jump polynomial published with xoshiro256**: the new state is the
+ * sum (exclusive or) of the states passed through at the polynomial's
+ * set bits.
  */
 
-int RandomGenerator::getRandomInteger(int low, int high)
+void RandomGenerator::jump()
 {
-  assert(low <= high);
-  double percent = (rand() / (static_cast<double>(RAND_MAX) + 1));
-  assert(percent >= 0.0 && percent < 1.0); 
-  int offset = static_cast<int>(percent * (high - low + 1));
-  return low + offset;
+  static const uint64_t kJump[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+  uint64_t jumped[4] = { 0, 0, 0, 0 };
+  for (int i = 0; i < 4; i++) {
+    for (int bit = 0; bit < 64; bit++) {
+      if (kJump[i] & (1ULL << bit))
+        for (int j = 0; j < 4; j++) jumped[j] ^= state[j];
+      next();
+    }
+  }
+  for (int j = 0; j < 4; j++) state[j] = jumped[j];
 }
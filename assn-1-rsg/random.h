@@ -5,9 +5,21 @@
  * File: random.h
  * --------------
  * Provides a random number generator so
- * that pseudo-random numbers can be produced.
+ * that pseudo-random numbers can be produced.  Each
+ * RandomGenerator carries its own state, so several
+ * of them can be used concurrently (one per thread)
+ * without interfering with one another.
+ *
+ * The engine is xoshiro256** (Blackman and Vigna), which
+ * has 256 bits of state, a period of 2^256 - 1, and costs a
+ * handful of shifts, rotates and multiplies per draw.  The
+ * drawing methods are defined right here in the header so
+ * they can be inlined into the expansion loop.
  */
 
+#include <stdint.h>
+#include <cassert> // for assert macro
+
 class RandomGenerator {
   
  public: 
@@ -15,11 +27,25 @@ class RandomGenerator {
   /**
    * Constructor: RandomGenerator
    * ----------------------------
-   * Constructs a new RandomGenerator object.
+   * Constructs a new RandomGenerator object seeded from the clock
+   * (to the nanosecond) and a per-process counter, so that generators
+   * constructed in quick succession still produce different streams.
    */
   
   RandomGenerator();
 
+  /**
+   * Constructor: RandomGenerator
+   * ----------------------------
+   * Constructs a new RandomGenerator object whose sequence of
+   * numbers is determined entirely by the specified seed.
+   * Generators given different seeds produce different streams.
+   *
+   * @param seed the starting state of the generator.
+   */
+
+  RandomGenerator(uint64_t seed);
+
   /**
    * Method: getRandomInteger
    * ------------------------
@@ -29,13 +55,67 @@ class RandomGenerator {
    * that number is guaranteed to be returned.  If low is greater than
    * high, then getRandomInteger asserts and ends the program.
    *
+   * Implementation note: this is Lemire's multiply-shift method.  A
+   * 32-bit draw times the size of the range is a 64-bit number whose
+   * upper half is the result, and draws whose lower half falls below
+   * 2^32 mod range are rejected, which makes every outcome exactly
+   * equally likely.  The division that computes the threshold is only
+   * needed in the rare case that the lower half is smaller than range.
+   *
    * @param the lowest number we'd like to be considered as a return value.
    * @param the highest number we'd like to be considered as a return value.
    * @return some number drawn uniformly from the range [low, high].
    */
   
-  int getRandomInteger(int low, int high);  
+  int getRandomInteger(int low, int high)
+  {
+    assert(low <= high);
+    uint32_t range = (uint32_t) high - (uint32_t) low + 1;
+    if (range == 0) return (int) next();  // [INT_MIN, INT_MAX]
+    uint64_t product = (uint64_t) (uint32_t) (next() >> 32) * range;
+    if ((uint32_t) product < range) {
+      uint32_t threshold = -range % range;
+      while ((uint32_t) product < threshold)
+        product = (uint64_t) (uint32_t) (next() >> 32) * range;
+    }
+    return (int) ((uint32_t) low + (uint32_t) (product >> 32));
+  }
+
+  /**
+   * Method: next
+   * ------------
+   * Returns the next 64 random bits.
+   */
+
+  uint64_t next()
+  {
+    uint64_t result = rotate(state[1] * 5, 7) * 9;
+    uint64_t shifted = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = rotate(state[3], 45);
+    return result;
+  }
+
+  /**
+   * Method: jump
+   * ------------
+   * Advances the generator by 2^128 draws, as if next had been called
+   * that many times.  Starting from one seed and jumping once more for
+   * each additional stream hands out streams that are guaranteed not to
+   * overlap for 2^128 draws apiece.
+   */
+
+  void jump();
+
+ private:
+  uint64_t state[4];
+
+  static uint64_t rotate(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+  void seed(uint64_t seed);
 };
 
 #endif // ! __random__
-
@@ -0,0 +1,374 @@
+/**
+ * File: rsg-bench.cc
+ * ------------------
+ * Provides the implementation of rsg-bench, which times sentence
+ * generation on a set of grammars with two engines: the current one
+ * (grammar-parser.h into a compiled Grammar, expanded by an Expander) and
+ * the original one, the map<string, Definition> with expandText and
+ * lsearch that rsg started out as, kept here verbatim as the baseline
+ * every engine change is measured against.
+ *
+ * Each grammar and engine is run in a child process of its own, so that
+ * its peak resident set size is its own, and a crash in one run doesn't
+ * take the rest of the suite down with it.
+ */
+
+#include <iostream>
+#include "grammar.h"
+#include "grammar-builder.h"
+#include "grammar-parser.h"
+#include "grammar-analysis.h"
+#include "definition.h"
+#include "production.h"
+#include "random.h"
+#include "expander.h"
+#include "output-buffer.h"
+#include "allocation-counter.h"
+#include <map>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <fstream>
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+/**
+ * Implementation note: readGrammar, lsearch, expandText
+ * -----------------------------------------------------
+ * The original engine, as it was before the compiled Grammar replaced it.
+ * The only change is that productions are drawn from a seeded
+ * RandomGenerator, so that runs are repeatable.
+ */
+
+static void readGrammar(ifstream& infile, map<string, Definition>& grammar)
+{
+  while (true) {
+    string uselessText;
+    getline(infile, uselessText, '{');
+    if (infile.eof()) return;
+    infile.putback('{');
+    Definition def(infile);
+    grammar[def.getNonterminal()] = def;
+  }
+}
+
+static int lsearch(const vector<string>& v, const string target)
+{
+  for (size_t i = 0; i < v.size(); i++) {
+    if (v[i].find(target) != string::npos)
+      return i;
+  }
+  return -1;
+}
+
+static void expandText(vector<string>& text, map<string, Definition>& grammar, RandomGenerator& random)
+{
+  int nontermIdx = lsearch(text, "<");
+  if (nontermIdx == -1) return;
+
+  string nonterminal = text[nontermIdx];
+  Definition newDefintion = grammar[nonterminal];
+  Production newProduction = newDefintion.getRandomProduction(random);
+
+  vector<string> insertion;
+  for (Production::iterator curr = newProduction.begin(); curr != newProduction.end(); ++curr) {
+    string word = *curr;
+    insertion.push_back(word);
+  }
+
+  expandText(insertion, grammar, random);
+
+  vector<string>::iterator it = text.begin();
+  text.erase(it + nontermIdx);
+
+  for (size_t i = 0; i < insertion.size(); i++) {
+    it = text.begin();
+    text.insert(it + nontermIdx + i, insertion[i]);
+  }
+}
+
+/**
+ * Convenience struct: Result
+ * --------------------------
+ * What one run measures, passed from the child that ran it back to the
+ * parent through a pipe, so it holds nothing but plain numbers.  peakRss
+ * is in kilobytes.
+ */
+
+struct Result {
+  double parseSeconds;
+  double generateSeconds;
+  long long sentences;
+  long long tokens;
+  long long bytes;
+  long long allocations;
+  long peakRss;
+};
+
+/**
+ * Function: runLegacy
+ * -------------------
+ * Parses the grammar with readGrammar and generates the sentences the way
+ * the original main did: expandText until no word contains a '<', and then
+ * the words joined with spaces, into a string rather than onto cout.
+ */
+
+static void runLegacy(const char *file, long long count, uint64_t seed, Result& result)
+{
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  ifstream grammarFile(file);
+  map<string, Definition> grammar;
+  readGrammar(grammarFile, grammar);
+  result.parseSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  RandomGenerator random(seed);
+  string sentence;
+  long long allocationsBefore = getNumAllocations();
+  begin = chrono::steady_clock::now();
+  for (long long i = 0; i < count; i++) {
+    vector<string> output;
+    output.push_back("<start>");
+    while (lsearch(output, "<") != -1) expandText(output, grammar, random);
+    sentence.clear();
+    for (size_t j = 0; j < output.size(); j++) sentence += output[j] + " ";
+    result.tokens += output.size();
+    result.bytes += sentence.size();
+  }
+  result.generateSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  result.allocations = getNumAllocations() - allocationsBefore;
+  result.sentences = count;
+}
+
+/**
+ * Function: runCurrent
+ * --------------------
+ * Parses the grammar into a compiled Grammar, and generates the sentences
+ * the way rsg --count does, through one OutputBuffer, here writing to
+ * /dev/null.  The tokens are counted afterwards, off the clock, by pulling
+ * the same sentences again with begin and next, which make exactly the
+ * same choices as expand given the same seed.
+ */
+
+static void runCurrent(const char *file, long long count, uint64_t seed, Result& result)
+{
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  GrammarBuilder builder;
+  parseGrammarFile(file, builder);
+  Grammar grammar(builder);
+  result.parseSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  int start = grammar.getNonterminal("<start>");
+  int fd = open("/dev/null", O_WRONLY);
+  RandomGenerator random(seed);
+  Expander expander(grammar);
+  OutputBuffer output(fd);
+  long long allocationsBefore = getNumAllocations();
+  begin = chrono::steady_clock::now();
+  for (long long i = 0; i < count; i++) {
+    expander.expand(start, random, output);
+    output.endLine();
+    output.endSentence();
+  }
+  output.flush();
+  result.generateSeconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  result.allocations = getNumAllocations() - allocationsBefore;
+  result.sentences = count;
+  result.bytes = output.getBytesWritten();
+  close(fd);
+
+  RandomGenerator replay(seed);
+  string_view token;
+  for (long long i = 0; i < count; i++) {
+    expander.begin(start);
+    while (expander.next(replay, token)) result.tokens++;
+  }
+}
+
+/**
+ * Function: runInChild
+ * --------------------
+ * Forks a child to make one run and hand its Result back.
+ *
+ * @return false if the child didn't deliver a Result (because it crashed,
+ *         say).
+ */
+
+static bool runInChild(void (*run)(const char *, long long, uint64_t, Result&),
+                       const char *file, long long count, uint64_t seed, Result& result)
+{
+  int fds[2];
+  if (pipe(fds) == -1) return false;
+  cout.flush();
+  pid_t pid = fork();
+  if (pid == -1) return false;
+  if (pid == 0) {
+    close(fds[0]);
+    Result measured;
+    memset(&measured, 0, sizeof(measured));
+    run(file, count, seed, measured);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    measured.peakRss = usage.ru_maxrss;
+    bool sent = write(fds[1], &measured, sizeof(measured)) == sizeof(measured);
+    _exit(sent ? 0 : 1);
+  }
+  close(fds[1]);
+  ssize_t received = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status;
+  waitpid(pid, &status, 0);
+  return received == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * Function: checkGrammar
+ * ----------------------
+ * Decides whether the grammar can be benchmarked, and whether the legacy
+ * engine can run it, which it can't if <start> can reach an undefined
+ * nonterminal: expandText would look it up, get an empty Definition, and
+ * choose from no productions at all.
+ *
+ * @return NULL if the grammar can be benchmarked, and the reason not otherwise.
+ */
+
+static const char *checkGrammar(const char *file, bool& legacyOk)
+{
+  GrammarBuilder builder;
+  if (!parseGrammarFile(file, builder)) return "can't be opened";
+  Grammar grammar(builder);
+  int start = grammar.getNonterminal("<start>");
+  GrammarAnalysis analysis(grammar, start);
+  if (start == -1 || !analysis.isDefined(start)) return "has no <start>";
+  if (!analysis.canTerminate(start)) return "never terminates";
+  if (analysis.getExpectedTokens(start) == HUGE_VAL) return "has unbounded expected length";
+  legacyOk = true;
+  for (int nonterminal = 0; nonterminal < grammar.getNumNonterminals(); nonterminal++)
+    if (analysis.isReachable(nonterminal) && !analysis.isDefined(nonterminal)) legacyOk = false;
+  return NULL;
+}
+
+/**
+ * Functions: printRow, writeRecord
+ * --------------------------------
+ * Print one run as a row of the table, and write it as one line of JSON.
+ * speedup is the run's sentences per second over the legacy engine's on
+ * the same grammar, or 0 if there's nothing to compare it with.
+ */
+
+static void printRow(const string& grammar, const string& engine, const Result& result, double speedup)
+{
+  double perSecond = result.sentences / result.generateSeconds;
+  cout << left << setw(16) << grammar << setw(8) << engine << right << fixed
+       << setprecision(3) << setw(10) << result.parseSeconds * 1000
+       << setprecision(0) << setw(14) << perSecond
+       << setw(14) << result.tokens / result.generateSeconds
+       << setprecision(2) << setw(12) << (double) result.allocations / result.sentences
+       << setprecision(1) << setw(10) << result.peakRss / 1024.0;
+  if (speedup > 0) cout << setw(10) << speedup << "x";
+  cout << endl;
+}
+
+static void writeRecord(ostream& out, const string& grammar, const string& engine, uint64_t seed,
+                        const Result& result)
+{
+  out << "{\"grammar\": \"" << grammar << "\", \"engine\": \"" << engine << "\", \"seed\": " << seed
+      << ", \"sentences\": " << result.sentences << ", \"tokens\": " << result.tokens
+      << ", \"bytes\": " << result.bytes << setprecision(9)
+      << ", \"parse_seconds\": " << result.parseSeconds
+      << ", \"generate_seconds\": " << result.generateSeconds
+      << ", \"sentences_per_second\": " << result.sentences / result.generateSeconds
+      << ", \"tokens_per_second\": " << result.tokens / result.generateSeconds
+      << ", \"allocations_per_sentence\": " << (double) result.allocations / result.sentences
+      << ", \"peak_rss_kb\": " << result.peakRss << "}" << endl;
+}
+
+static const char *const kUsage =
+  "Usage: rsg-bench [--seed N] [--count N] [--legacy-count N] [--json FILE] <grammar file> ...";
+
+/**
+ * Function: main
+ * --------------
+ * Runs every grammar named on the command line through both engines,
+ * prints a table of the results, and writes them as JSON lines to the
+ * --json file if there is one.  The current engine generates --count
+ * sentences (20000 by default) and the legacy one --legacy-count
+ * (200 by default), since it's far slower; every rate is per second of
+ * generation, so the two are comparable all the same.  Both draw from
+ * generators seeded with --seed (1 by default).  Parse times are for the
+ * grammar file alone, and the peak RSS includes the two or three
+ * megabytes the benchmark itself starts out with.
+ *
+ * Usage: rsg-bench [--seed N] [--count N] [--legacy-count N] [--json FILE] <grammar file> ...
+ */
+
+int main(int argc, char *argv[])
+{
+  uint64_t seed = 1;
+  long long count = 20000, legacyCount = 200;
+  const char *jsonFile = NULL;
+  vector<const char *> files;
+  bool malformed = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 0);
+    else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = atoll(argv[++i]);
+    else if (strcmp(argv[i], "--legacy-count") == 0 && i + 1 < argc) legacyCount = atoll(argv[++i]);
+    else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonFile = argv[++i];
+    else if (argv[i][0] != '-') files.push_back(argv[i]);
+    else malformed = true;
+  }
+  if (malformed || files.empty() || count < 1 || legacyCount < 1) {
+    cerr << kUsage << endl;
+    return 1;
+  }
+
+  ofstream json;
+  if (jsonFile != NULL) json.open(jsonFile);
+  cout << left << setw(16) << "grammar" << setw(8) << "engine" << right << setw(10) << "parse ms"
+       << setw(14) << "sentences/s" << setw(14) << "tokens/s" << setw(12) << "allocs/sent"
+       << setw(10) << "peak MB" << setw(11) << "speedup" << endl;
+  for (size_t i = 0; i < files.size(); i++) {
+    string name = files[i];
+    if (name.rfind('/') != string::npos) name = name.substr(name.rfind('/') + 1);
+    bool legacyOk = false;
+    const char *reason = checkGrammar(files[i], legacyOk);
+    if (reason != NULL) {
+      cout << left << setw(16) << name << "skipped: the grammar " << reason << "." << endl;
+      continue;
+    }
+
+    Result legacy, current;
+    double legacyRate = 0;
+    if (!legacyOk) {
+      cout << left << setw(16) << name << setw(8) << "legacy"
+           << "skipped: <start> reaches an undefined nonterminal." << endl;
+    } else if (!runInChild(runLegacy, files[i], legacyCount, seed, legacy)) {
+      cout << left << setw(16) << name << setw(8) << "legacy" << "failed." << endl;
+    } else {
+      printRow(name, "legacy", legacy, 0);
+      if (json.is_open()) writeRecord(json, name, "legacy", seed, legacy);
+      legacyRate = legacy.sentences / legacy.generateSeconds;
+    }
+    if (!runInChild(runCurrent, files[i], count, seed, current)) {
+      cout << left << setw(16) << name << setw(8) << "current" << "failed." << endl;
+      continue;
+    }
+    double speedup = legacyRate > 0 ? current.sentences / current.generateSeconds / legacyRate : 0;
+    printRow(name, "current", current, speedup);
+    if (json.is_open()) writeRecord(json, name, "current", seed, current);
+  }
+  if (json.is_open()) {
+    json.close();
+    if (json.fail()) {
+      cerr << "Failed to write the results to \"" << jsonFile << "\"." << endl;
+      return 4;
+    }
+  }
+  return 0;
+}
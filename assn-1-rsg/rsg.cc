@@ -1,164 +1,1074 @@
 /**
  * File: rsg.cc
  * ------------
- * Provides the implementation of the full RSG application, which
- * relies on the services of the built-in string, ifstream, vector,
- * and map classes as well as the custom Production and Definition
- * classes provided with the assignment.
+ * Provides the implementation of the full RSG application.  The
+ * grammar file is parsed straight into a compiled Grammar (see
+ * grammar-parser.h and grammar.h), and sentences are expanded from
+ * that by an Expander (see expander.h).
  */
  
-#include <map>
-#include <fstream>
-#include "definition.h"
-#include "production.h"
+#include <iostream>
+#include "grammar.h"
+#include "grammar-builder.h"
+#include "grammar-parser.h"
+#include "grammar-analysis.h"
+#include "grammar-optimizer.h"
+#include "grammar-emitter.h"
+#include "sentence-counter.h"
+#include "length-table.h"
+#include "fingerprinter.h"
+#include "fingerprint-set.h"
+#include "expansion-profile.h"
+#include "random.h"
+#include "expander.h"
+#include "output-buffer.h"
+#include "allocation-counter.h"
 #include <vector> 
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <string.h>
+#include <math.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
 /**
- * Takes a reference to a legitimate infile (one that's been set up
- * to layer over a file) and populates the grammar map with the
- * collection of definitions that are spelled out in the referenced
- * file.  The function is written under the assumption that the
- * referenced data file is really a grammar file that's properly
- * formatted.  You may assume that all grammars are in fact properly
- * formatted.
+ * Convenience struct: Options
+ * ---------------------------
+ * Everything specified on the command line.
+ *
+ * count is the number of sentences to generate, and outputFile is NULL
+ * when they're to be written to standard output.  bulk is set whenever
+ * --count or --output is given, in which case the chatter (the definition
+ * count and the throughput report) goes to cerr so the output holds
+ * nothing but sentences.  numThreads is the number of worker threads, and
+ * unordered allows the workers' chunks of sentences to be written in
+ * whatever order they finish.
+ *
+ * seed is the seed every random choice derives from; seeded says whether
+ * it came from --seed, and it's drawn from the clock otherwise.
+ * counterBased selects PhiloxGenerator streams keyed by sentence index,
+ * and first is the index of the first sentence generated.
+ *
+ * compile asks for the grammar to be compiled into the binary image named
+ * imageFile rather than generated from, and analyze for the grammar's
+ * analysis (see grammar-analysis.h) to be printed instead.  optimize asks
+ * for the grammar to be optimized (see grammar-optimizer.h) before it's
+ * compiled, analyzed or generated from, and emitCpp for the source of a
+ * generator specialized to the grammar (see grammar-emitter.h) to be
+ * written to outputFile or cout instead of any sentences.
+ *
+ * maxDepth and maxTokens bound every sentence (see Expander::setLimits),
+ * and are INT_MAX and LLONG_MAX when there's no bound.  uniformTokens, if
+ * it isn't -1, asks for derivations of at most that many tokens to be
+ * sampled uniformly (see sentence-counter.h).  minLength and maxLength,
+ * if they aren't -1, ask for every sentence to have a number of tokens in
+ * that range (see length-table.h).
  *
- * @param infile a valid reference to a flat text file storing the grammar.
- * @param grammar a reference to the STL map, which maps nonterminal strings
- *                to their definitions.
+ * unique asks for count distinct sentences, with duplicates detected by
+ * fingerprint (see fingerprinter.h) and regenerated.  profile asks for a
+ * report of where the expansions, tokens and time went (see
+ * expansion-profile.h) once the run is over.
  */
 
-static void readGrammar(ifstream& infile, map<string, Definition>& grammar)
+struct Options {
+  const char *grammarFile;
+  const char *outputFile;
+  long long count;
+  bool bulk;
+  int numThreads;
+  bool unordered;
+  uint64_t seed;
+  bool seeded;
+  bool counterBased;
+  long long first;
+  bool compile;
+  const char *imageFile;
+  bool analyze;
+  bool optimize;
+  bool emitCpp;
+  int maxDepth;
+  long long maxTokens;
+  int uniformTokens;
+  int minLength;
+  int maxLength;
+  bool unique;
+  bool profile;
+};
+
+static const char *const kUsage =
+  "Usage: rsg --compile [--optimize] <path to grammar text file> <path to image file>\n"
+  "       rsg --analyze [--optimize] <path to grammar text or image file>\n"
+  "       rsg --emit-cpp [--optimize] [--output FILE] <path to grammar text or image file>\n"
+  "       rsg [--count N | --unique N] [--output FILE] [--threads N] [--unordered] [--seed N]\n"
+  "           [--counter-based] [--first N] [--max-depth N] [--max-tokens N]\n"
+  "           [--optimize] [--uniform N] [--length N | --length MIN-MAX]\n"
+  "           [--profile] <path to grammar text or image file>";
+
+/**
+ * Function: parseLengthRange
+ * --------------------------
+ * Parses the argument to --length, either a single length or a range
+ * written MIN-MAX.  The range can end no later than kMaxLength, since
+ * working out which lengths each nonterminal reaches takes time that
+ * grows with the square of the longest: about three seconds for trek.g
+ * at the cap.
+ *
+ * @return false if the argument is malformed, the range is empty, or it
+ *         ends past kMaxLength.
+ */
+
+static const int kMaxLength = 20000;
+
+static bool parseLengthRange(const char *arg, Options& options)
 {
-  while (true) {
-    string uselessText;
-    getline(infile, uselessText, '{');
-    if (infile.eof()) return;  // true? we encountered EOF before we saw a '{': no more productions!
-    infile.putback('{');
-    Definition def(infile);
-    grammar[def.getNonterminal()] = def;
+  char *end;
+  long minLength = strtol(arg, &end, 10);
+  long maxLength = minLength;
+  if (end != arg && *end == '-') {
+    const char *rest = end + 1;
+    maxLength = strtol(rest, &end, 10);
+    if (end == rest) return false;
   }
+  if (end == arg || *end != '\0' || minLength < 0 || maxLength < minLength || maxLength > kMaxLength) return false;
+  options.minLength = minLength;
+  options.maxLength = maxLength;
+  return true;
 }
 
+/**
+ * Function: parseOptions
+ * ----------------------
+ * Populates the specified Options from the command line.  --count and
+ * --unique both set the number of sentences, so they can't be combined.
+ * --uniform and --length override --max-depth and --max-tokens, so
+ * neither can be combined with them either.  --uniform is capped at
+ * kMaxUniformTokens, since counting the derivations takes time and
+ * memory that grow with the square of the bound: about ten seconds and
+ * a hundred megabytes for trek.g at the cap.
+ *
+ * @return false if the command line is malformed.
+ */
+
+static const int kMaxUniformTokens = 4000;
+
+static bool parseOptions(int argc, char *argv[], Options& options)
+{
+  options.grammarFile = NULL;
+  options.outputFile = NULL;
+  options.count = 1;
+  options.bulk = false;
+  options.numThreads = 1;
+  options.unordered = false;
+  options.seed = 0;
+  options.seeded = false;
+  options.counterBased = false;
+  options.first = 0;
+  options.compile = false;
+  options.imageFile = NULL;
+  options.analyze = false;
+  options.optimize = false;
+  options.emitCpp = false;
+  options.maxDepth = INT_MAX;
+  options.maxTokens = LLONG_MAX;
+  options.uniformTokens = -1;
+  options.minLength = -1;
+  options.maxLength = -1;
+  options.unique = false;
+  options.profile = false;
+  bool counted = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+      options.count = atoll(argv[++i]);
+      options.bulk = true;
+      counted = true;
+      if (options.count < 0) return false;
+    } else if (strcmp(argv[i], "--unique") == 0 && i + 1 < argc) {
+      options.count = atoll(argv[++i]);
+      options.bulk = true;
+      options.unique = true;
+      if (options.count < 0) return false;
+    } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+      options.outputFile = argv[++i];
+      options.bulk = true;
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      options.numThreads = atoi(argv[++i]);
+      if (options.numThreads < 1) return false;
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      char *end;
+      options.seed = strtoull(argv[++i], &end, 0);
+      options.seeded = true;
+      if (*end != '\0') return false;
+    } else if (strcmp(argv[i], "--counter-based") == 0) {
+      options.counterBased = true;
+    } else if (strcmp(argv[i], "--first") == 0 && i + 1 < argc) {
+      options.first = atoll(argv[++i]);
+      options.counterBased = true;
+      if (options.first < 0) return false;
+    } else if (strcmp(argv[i], "--max-depth") == 0 && i + 1 < argc) {
+      options.maxDepth = atoi(argv[++i]);
+      if (options.maxDepth < 0) return false;
+    } else if (strcmp(argv[i], "--max-tokens") == 0 && i + 1 < argc) {
+      options.maxTokens = atoll(argv[++i]);
+      if (options.maxTokens < 0) return false;
+    } else if (strcmp(argv[i], "--uniform") == 0 && i + 1 < argc) {
+      options.uniformTokens = atoi(argv[++i]);
+      if (options.uniformTokens < 0 || options.uniformTokens > kMaxUniformTokens) return false;
+    } else if (strcmp(argv[i], "--length") == 0 && i + 1 < argc) {
+      if (!parseLengthRange(argv[++i], options)) return false;
+    } else if (strcmp(argv[i], "--profile") == 0) {
+      options.profile = true;
+    } else if (strcmp(argv[i], "--analyze") == 0) {
+      options.analyze = true;
+    } else if (strcmp(argv[i], "--emit-cpp") == 0) {
+      options.emitCpp = true;
+      options.bulk = true;
+    } else if (strcmp(argv[i], "--optimize") == 0) {
+      options.optimize = true;
+    } else if (strcmp(argv[i], "--compile") == 0) {
+      options.compile = true;
+    } else if (strcmp(argv[i], "--unordered") == 0) {
+      options.unordered = true;
+    } else if (argv[i][0] != '-' && options.grammarFile == NULL) {
+      options.grammarFile = argv[i];
+    } else if (argv[i][0] != '-' && options.compile && options.imageFile == NULL) {
+      options.imageFile = argv[i];
+    } else {
+      return false;
+    }
+  }
+  if (options.unique && counted) return false;
+  bool limited = options.maxDepth != INT_MAX || options.maxTokens != LLONG_MAX;
+  if ((options.uniformTokens != -1 || options.minLength != -1) && limited) return false;
+  if (options.emitCpp && limited) return false;
+  if (options.minLength != -1 && (options.emitCpp || options.uniformTokens != -1)) return false;
+  if (options.profile && (options.emitCpp || options.uniformTokens != -1 || options.minLength != -1)) return false;
+  return options.grammarFile != NULL && (!options.compile || options.imageFile != NULL);
+}
 
 /**
- * Implementation note: lsearch
+ * Convenience struct: Workload
  * ----------------------------
- * linear search. returns the index of the target if the target is found, -1 otherwise.  
- * 
- * Used in the program to search for '<' to determine if there are more expansions required.
- * 
- * @param v:  vector of strings that we're searching
- * @param target: the character that we're searching for
- */ 
- 
+ * Everything the worker threads share.  The sentences are carved into
+ * chunks of kSentencesPerChunk, and worker i of n generates chunks
+ * i, i + n, i + 2n, and so on.  The assignment is fixed rather than
+ * first come, first served, so a given seed and thread count always
+ * produce the same chunks from the same streams.  Each chunk is
+ * generated into the worker's own buffer without any locking, and only
+ * the write itself happens under the lock.  In ordered mode a worker
+ * holding a finished chunk waits until nextToWrite says it's that chunk's
+ * turn.
+ *
+ * counter and table are NULL unless the run samples uniformly or targets
+ * a length range.  seen is NULL unless sentences must be unique; it's
+ * sized for every sentence requested and built before the clock starts,
+ * and exhausted is set once a worker has given up on finding a new
+ * sentence.  Which sentences are duplicates depends on the order they're
+ * checked in, so a unique chunk is only drawn without the lock, and
+ * checked against seen under it, in its turn.  That keeps ordered unique
+ * runs as reproducible as the rest, with counter-based ones the same for
+ * any thread count; unordered ones are neither.  profile is NULL unless
+ * the run is profiled, in which case each worker keeps a profile of its
+ * own and merges it in when it's done.
+ */
 
-int lsearch(const vector<string>& v, const string target){ 
-  for (int i = 0; i < v.size(); i++) {
-	// string::npos is the constant that the string function .find returns if there is no match
-    if( v[i].find(target) != string::npos ) 
-      return i; 
+static const long long kSentencesPerChunk = 1024;
+static const double kMaxReservation = 64 << 20;
+
+struct Workload {
+  const Options *options;
+  const Grammar *grammar;
+  const GrammarAnalysis *analysis;
+  const SentenceCounter *counter;
+  const LengthTable *table;
+  const Fingerprinter *fingerprinter;
+  FingerprintSet *seen;
+  ExpansionProfile *profile;
+  int start;
+  int fd;
+  size_t chunkBytes;
+  long long count;
+  long long numChunks;
+  int numWorkers;
+  bool ordered;
+  atomic<bool> failed;
+  atomic<bool> exhausted;
+  atomic<long long> numSentences;
+  atomic<long long> numDuplicates;
+  mutex lock;
+  condition_variable turn;
+  long long nextToWrite;
+};
+
+/**
+ * Function: expandSentence
+ * ------------------------
+ * Appends one expansion of the specified nonterminal to the output.  If
+ * seen isn't NULL, the sentence must also be one that's never been seen,
+ * so each one whose fingerprint is already in seen is taken back out of
+ * the output (which can't have been flushed mid-sentence) and counted,
+ * and another is drawn from the same generator.  maxRun is the number of
+ * duplicates in a row that it's willing to draw, which is
+ * kMaxDuplicateRun unless some have been drawn already.
+ *
+ * @return false if maxRun duplicates in a row came up, in which case
+ *         nothing was appended.
+ */
+
+static const int kMaxDuplicateRun = 100000;
+
+template <class Generator>
+static bool expandSentence(Expander& expander, int start, Generator& random, OutputBuffer& output,
+                           FingerprintSet *seen, long long& numDuplicates, int maxRun = kMaxDuplicateRun)
+{
+  if (seen == NULL) {
+    expander.expand(start, random, output);
+    return true;
   }
-  return -1; 
+  size_t mark = output.getSize();
+  for (int run = 0; run < maxRun; run++) {
+    expander.expand(start, random, output);
+    if (seen->insert(expander.getFingerprint())) return true;
+    output.truncate(mark);
+    numDuplicates++;
+  }
+  return false;
 }
 
 /**
- * Implementation note: expandText
- * -------------------------------
- * expandText recursively expands the text. As long as the text contains non-terminals (i.e. <non-terminal>) 
- * then one of the non-terminal's productions is randomly selected, the production expands the sequence, and
- * then we recur.
- * 
- * @param text: the text that we're expanding. We store the text 
- *              in a vector.
- * @param grammar: a map with the non-terminal and their productions 
+ * Function: generateRange
+ * -----------------------
+ * Appends sentences [first, last) of the run to the output, one per line.
+ * In counter-based mode each sentence draws from its own PhiloxGenerator,
+ * keyed by the seed and the sentence's index, and random goes unused;
+ * otherwise every sentence draws from random in turn.
+ *
+ * @return the number of sentences appended, which is less than
+ *         last - first only if expandSentence gave up on one.
  */
 
+static long long generateRange(Expander& expander, int start, long long first, long long last,
+                               const Options& options, RandomGenerator& random, OutputBuffer& output,
+                               FingerprintSet *seen, long long& numDuplicates)
+{
+  for (long long i = first; i < last; i++) {
+    bool expanded;
+    if (options.counterBased) {
+      PhiloxGenerator stream(options.seed, options.first + i);
+      expanded = expandSentence(expander, start, stream, output, seen, numDuplicates);
+    } else {
+      expanded = expandSentence(expander, start, random, output, seen, numDuplicates);
+    }
+    if (!expanded) return i - first;
+    output.endLine();
+  }
+  return last - first;
+}
 
+/**
+ * Convenience struct: DrawnChunk
+ * ------------------------------
+ * A chunk of sentences drawn by a worker without regard to whether
+ * they're unique.  text holds the sentences, one per line, and is never
+ * flushed; ends holds the offset just past each one, and fingerprints
+ * their fingerprints.  In counter-based mode streams holds each
+ * sentence's PhiloxGenerator as drawing it left it, so that a duplicate
+ * can be redrawn from where its own stream left off.
+ */
 
-void expandText(vector<string>& text, map<string, Definition>& grammar){ 
-  
-  // find a non-terminal 
-  int nontermIdx = lsearch(text, "<"); 
-  // base case: non-terminal not found, we're done
-  if ( nontermIdx == -1 ) return; 
-  
-  
-  string nonterminal = text[nontermIdx]; 
-  // definition is a non-terminal and the non-terminals productions
-  Definition newDefintion = grammar[nonterminal]; 
-  Production newProduction = newDefintion.getRandomProduction(); 
-  
-  // declare a new vector and push the production onto the vector
-  vector<string> insertion; 
-  for (Production::iterator curr = newProduction.begin(); curr != newProduction.end(); ++curr) { 
-    string word = *curr; 
-    insertion.push_back(word);
-  }
-   
-  // expand the insertion 
-  expandText(insertion, grammar);
-  
-  // remove the non-terminal
-  vector<string>::iterator it = text.begin(); 
-  text.erase(it + nontermIdx); 
+struct DrawnChunk {
+  OutputBuffer text;
+  vector<size_t> ends;
+  vector<uint64_t> fingerprints;
+  vector<PhiloxGenerator> streams;
 
-  // insert the expanded text starting at the location of non-terminal the expansion replaces
-  for (int i = 0; i < insertion.size(); i++){
-    it = text.begin(); 
-    text.insert(it + nontermIdx + i, insertion[i]); 
+  DrawnChunk(size_t chunkBytes) : text(-1)
+  {
+    text.reserve(chunkBytes);
+    ends.reserve(kSentencesPerChunk);
+    fingerprints.reserve(kSentencesPerChunk);
+    streams.reserve(kSentencesPerChunk);
+  }
+
+  ~DrawnChunk() { text.discard(); }
+};
+
+/**
+ * Function: drawRange
+ * -------------------
+ * Replaces the contents of the specified DrawnChunk with sentences
+ * [first, last) of the run, drawn from the same streams generateRange
+ * would use, but without consulting or touching seen.
+ */
+
+static void drawRange(Expander& expander, int start, long long first, long long last,
+                      const Options& options, RandomGenerator& random, DrawnChunk& drawn)
+{
+  drawn.text.discard();
+  drawn.ends.clear();
+  drawn.fingerprints.clear();
+  drawn.streams.clear();
+  for (long long i = first; i < last; i++) {
+    if (options.counterBased) {
+      PhiloxGenerator stream(options.seed, options.first + i);
+      expander.expand(start, stream, drawn.text);
+      drawn.streams.push_back(stream);
+    } else {
+      expander.expand(start, random, drawn.text);
+    }
+    drawn.text.endLine();
+    drawn.ends.push_back(drawn.text.getSize());
+    drawn.fingerprints.push_back(expander.getFingerprint());
   }
 }
- 
+
+/**
+ * Function: keepUniqueRange
+ * -------------------------
+ * Appends the sentences of a DrawnChunk to the output in order, keeping
+ * each one whose fingerprint seen doesn't already have and redrawing each
+ * one it does from that sentence's own stream in counter-based mode, or
+ * from random otherwise.  Each sentence is checked against exactly the
+ * sentences before it, just as generateRange checks them, so the result
+ * depends only on the order in which chunks are kept.
+ *
+ * @return the number of sentences appended, which is less than the
+ *         number drawn only if expandSentence gave up on one.
+ */
+
+static long long keepUniqueRange(Expander& expander, int start, const Options& options, RandomGenerator& random,
+                                 DrawnChunk& drawn, OutputBuffer& output, FingerprintSet *seen,
+                                 long long& numDuplicates)
+{
+  long long kept = 0;
+  size_t begin = 0;
+  for (size_t i = 0; i < drawn.ends.size(); i++, kept++) {
+    if (seen->insert(drawn.fingerprints[i])) {
+      output.append(drawn.text.getData() + begin, drawn.ends[i] - begin);
+    } else {
+      numDuplicates++;
+      bool expanded = options.counterBased ?
+        expandSentence(expander, start, drawn.streams[i], output, seen, numDuplicates, kMaxDuplicateRun - 1) :
+        expandSentence(expander, start, random, output, seen, numDuplicates, kMaxDuplicateRun - 1);
+      if (!expanded) break;
+      output.endLine();
+    }
+    begin = drawn.ends[i];
+  }
+  return kept;
+}
+
+/**
+ * Function: runWorker
+ * -------------------
+ * Generates the specified worker's chunks, using a RandomGenerator,
+ * Expander and OutputBuffer that belong to this worker alone.  Every
+ * chunk is written (or discarded, once a write has failed) so that
+ * ordered workers never wait on a chunk that won't come, and once any
+ * worker has run out of unique sentences, the rest of the chunks are
+ * left empty.  In unique mode each chunk is drawn without the lock and
+ * kept (see keepUniqueRange) under it, in its turn.
+ */
+
+static void runWorker(Workload& work, int worker, RandomGenerator random, size_t& bytesWritten)
+{
+  Expander expander(*work.grammar);
+  expander.setLimits(*work.analysis, work.options->maxDepth, work.options->maxTokens);
+  if (work.counter != NULL) expander.setUniform(*work.counter);
+  if (work.table != NULL) expander.setTargetLength(*work.table, work.options->minLength, work.options->maxLength);
+  if (work.seen != NULL) expander.setFingerprinter(*work.fingerprinter);
+  ExpansionProfile *profile = work.profile != NULL ? new ExpansionProfile(*work.grammar) : NULL;
+  if (profile != NULL) expander.setProfile(*profile);
+  OutputBuffer output(work.fd);
+  output.reserve(work.chunkBytes);
+  DrawnChunk *drawn = work.seen != NULL ? new DrawnChunk(work.chunkBytes) : NULL;
+  long long numDuplicates = 0;
+  for (long long chunk = worker; chunk < work.numChunks; chunk += work.numWorkers) {
+    long long first = chunk * kSentencesPerChunk, last = min(first + kSentencesPerChunk, work.count);
+    if (drawn != NULL) {
+      if (!work.exhausted) drawRange(expander, work.start, first, last, *work.options, random, *drawn);
+    } else {
+      long long generated = generateRange(expander, work.start, first, last, *work.options, random, output,
+                                          NULL, numDuplicates);
+      work.numSentences += generated;
+    }
+
+    unique_lock<mutex> guard(work.lock);
+    while (work.ordered && work.nextToWrite != chunk) work.turn.wait(guard);
+    if (drawn != NULL && !work.exhausted) {
+      long long kept = keepUniqueRange(expander, work.start, *work.options, random, *drawn, output, work.seen,
+                                       numDuplicates);
+      if (kept < last - first) work.exhausted = true;
+      work.numSentences += kept;
+    }
+    if (work.failed) output.discard();
+    else if (!output.flush()) work.failed = true;
+    work.nextToWrite++;
+    guard.unlock();
+    if (work.ordered) work.turn.notify_all();
+  }
+  delete drawn;
+  bytesWritten = output.getBytesWritten();
+  work.numDuplicates += numDuplicates;
+  if (profile != NULL) {
+    expander.flushProfile();
+    lock_guard<mutex> guard(work.lock);
+    work.profile->merge(*profile);
+    delete profile;
+  }
+}
+
+/**
+ * Function: generateSentences
+ * ---------------------------
+ * Generates the requested number of expansions of the specified
+ * nonterminal, one per line.  With a single thread, every sentence goes
+ * through one OutputBuffer that's reused throughout and flushed in large
+ * writes.  Otherwise a pool of workers generates chunks in parallel (see
+ * Workload), each with its own stream: worker i's generator is the seeded
+ * one jumped i times, so no two workers' streams can overlap.  In
+ * counter-based mode the streams belong to the sentences instead, so the
+ * output is the same no matter how many threads produce it.
+ *
+ * In bulk mode, the number of bytes generated, the throughput and the
+ * number of heap allocations made along the way are reported on cerr.
+ * Once the buffers and stacks have grown to fit, generating a sentence
+ * allocates nothing, so the count depends on the thread count but not on
+ * the number of sentences.  In unique mode, the number of duplicates
+ * thrown away is reported as well.
+ *
+ * @param analysis supplies the expected size of a sentence, used to size
+ *                 each worker's buffer for a whole chunk up front, and the
+ *                 shortest productions any limits fall back on.
+ * @param counter NULL unless sentences are to be sampled uniformly.
+ * @param table NULL unless their lengths are to be kept within the range
+ *              in options.
+ * @param profile NULL, or the profile to fill in.
+ * @param numSentences set to the number of sentences generated, which is
+ *                     less than requested only if too few unique ones
+ *                     could be found.
+ * @return false if the output couldn't be written.
+ */
+
+static bool generateSentences(const Grammar& grammar, const GrammarAnalysis& analysis,
+                              const SentenceCounter *counter, const LengthTable *table, int start, int fd,
+                              const Options& options, ExpansionProfile *profile, long long& numSentences)
+{
+  double expectedBytes = analysis.getExpectedBytes(start);
+  double chunkBytes = min(expectedBytes * kSentencesPerChunk * 1.25, kMaxReservation);
+  Fingerprinter *fingerprinter = options.unique ? new Fingerprinter(grammar) : NULL;
+  FingerprintSet *seen = options.unique ? new FingerprintSet(options.count) : NULL;
+  chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+  long long allocationsBefore = getNumAllocations();
+  RandomGenerator random(options.seed);
+  size_t totalBytes = 0;
+  long long numDuplicates = 0;
+  numSentences = 0;
+  bool ok;
+  if (options.numThreads == 1) {
+    Expander expander(grammar);
+    expander.setLimits(analysis, options.maxDepth, options.maxTokens);
+    if (counter != NULL) expander.setUniform(*counter);
+    if (table != NULL) expander.setTargetLength(*table, options.minLength, options.maxLength);
+    if (seen != NULL) expander.setFingerprinter(*fingerprinter);
+    if (profile != NULL) expander.setProfile(*profile);
+    OutputBuffer output(fd);
+    for (long long first = 0; first < options.count; first += kSentencesPerChunk) {
+      long long last = min(first + kSentencesPerChunk, options.count);
+      long long generated = generateRange(expander, start, first, last, options, random, output,
+                                          seen, numDuplicates);
+      numSentences += generated;
+      output.endSentence();
+      if (generated < last - first) break;
+    }
+    expander.flushProfile();
+    ok = output.flush();
+    totalBytes = output.getBytesWritten();
+  } else {
+    Workload work;
+    work.options = &options;
+    work.grammar = &grammar;
+    work.analysis = &analysis;
+    work.counter = counter;
+    work.table = table;
+    work.fingerprinter = fingerprinter;
+    work.seen = seen;
+    work.profile = profile;
+    work.start = start;
+    work.fd = fd;
+    work.chunkBytes = (size_t) chunkBytes;
+    work.count = options.count;
+    work.numChunks = (options.count + kSentencesPerChunk - 1) / kSentencesPerChunk;
+    work.numWorkers = options.numThreads;
+    work.ordered = !options.unordered;
+    work.failed = false;
+    work.exhausted = false;
+    work.numSentences = 0;
+    work.numDuplicates = 0;
+    work.nextToWrite = 0;
+
+    vector<size_t> bytesWritten(options.numThreads, 0);
+    vector<thread> workers;
+    for (int i = 0; i < options.numThreads; i++) {
+      workers.push_back(thread(runWorker, ref(work), i, random, ref(bytesWritten[i])));
+      random.jump();
+    }
+    for (int i = 0; i < options.numThreads; i++) {
+      workers[i].join();
+      totalBytes += bytesWritten[i];
+    }
+    ok = !work.failed;
+    numSentences = work.numSentences;
+    numDuplicates = work.numDuplicates;
+  }
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  long long allocations = getNumAllocations() - allocationsBefore;
+  delete fingerprinter;
+  delete seen;
+
+  if (options.bulk) {
+    double megabytes = totalBytes / (1024.0 * 1024.0);
+    cerr << "Generated " << numSentences << " sentences (" << fixed << setprecision(1)
+         << megabytes << " MB) with " << options.numThreads << " thread(s) in "
+         << setprecision(3) << elapsed << "s: "
+         << setprecision(1) << (elapsed > 0 ? megabytes / elapsed : 0) << " MB/s (seed "
+         << options.seed << ", " << allocations << " heap allocations)." << endl;
+  }
+  if (options.unique) {
+    long long numDrawn = numSentences + numDuplicates;
+    cerr << "Threw away " << numDuplicates << " duplicates, " << setprecision(2)
+         << (numDrawn > 0 ? 100.0 * numDuplicates / numDrawn : 0) << "% of the sentences drawn." << endl;
+  }
+  return ok;
+}
+
+/**
+ * Function: formatCount
+ * ---------------------
+ * Formats an expected or minimum count for the analysis table, to one
+ * decimal place unless that place would be 0.  The count is rounded before
+ * the choice is made, so that a sum like six sixths, which comes out a
+ * hair under 1, prints as 1 just like an exact 1 does.
+ */
+
+static string formatCount(double count)
+{
+  if (count == HUGE_VAL || count >= (double) GrammarAnalysis::kUnbounded) return "unbounded";
+  double rounded = round(count * 10) / 10;
+  ostringstream out;
+  out << fixed << setprecision(rounded == floor(rounded) ? 0 : 1) << rounded;
+  return out.str();
+}
+
+/**
+ * Function: printNames
+ * --------------------
+ * Prints the names of the nonterminals passing the specified test on one
+ * line, or "none".
+ */
+
+template <class Predicate>
+static void printNames(const Grammar& grammar, const string& label, Predicate test, ostream& out)
+{
+  out << "  " << label << ":";
+  int count = 0;
+  for (int nonterminal = 0; nonterminal < grammar.getNumNonterminals(); nonterminal++)
+    if (test(nonterminal)) out << (count++ == 0 ? " " : ", ") << grammar.getName(nonterminal);
+  if (count == 0) out << " none";
+  out << endl;
+}
+
+/**
+ * Function: printAnalysis
+ * -----------------------
+ * Prints the findings of the specified analysis: the problem
+ * nonterminals first, then a table of every reachable nonterminal's
+ * production count and minimum and expected expansion lengths.
+ */
+
+static void printAnalysis(const Grammar& grammar, const GrammarAnalysis& analysis, int start, ostream& out)
+{
+  int numDefined = 0;
+  for (int nonterminal = 0; nonterminal < grammar.getNumNonterminals(); nonterminal++)
+    if (analysis.isDefined(nonterminal)) numDefined++;
+  out << "  " << grammar.getNumNonterminals() << " nonterminals (" << numDefined << " defined), "
+      << grammar.getNumProductions() << " productions, " << grammar.getNumTerminals()
+      << " distinct terminals." << endl;
+  printNames(grammar, "Undefined", [&](int nt) { return !analysis.isDefined(nt); }, out);
+  printNames(grammar, "Unreachable from <start>", [&](int nt) { return !analysis.isReachable(nt); }, out);
+  printNames(grammar, "Can never terminate", [&](int nt) { return !analysis.canTerminate(nt); }, out);
+  printNames(grammar, "Unbounded expected length",
+             [&](int nt) { return analysis.canTerminate(nt) && analysis.getExpectedTokens(nt) == HUGE_VAL; }, out);
+  if (start == -1) {
+    out << "  The grammar never mentions <start>." << endl;
+    return;
+  }
+
+  out << endl << "  " << left << setw(32) << "nonterminal" << right << setw(12) << "productions"
+      << setw(12) << "min tokens" << setw(16) << "exp. tokens" << setw(16) << "exp. bytes" << endl;
+  for (int nonterminal = 0; nonterminal < grammar.getNumNonterminals(); nonterminal++) {
+    if (!analysis.isReachable(nonterminal)) continue;
+    out << "  " << left << setw(32) << grammar.getName(nonterminal) << right
+        << setw(12) << grammar.getRule(nonterminal).length
+        << setw(12) << formatCount(analysis.getMinTokens(nonterminal))
+        << setw(16) << formatCount(analysis.getExpectedTokens(nonterminal))
+        << setw(16) << formatCount(analysis.getExpectedBytes(nonterminal)) << endl;
+  }
+}
+
+/**
+ * Function: describeProduction
+ * ----------------------------
+ * Returns a production's symbols as they'd appear in the grammar file,
+ * cut short if they run past kMaxDescription characters.
+ */
+
+static const size_t kMaxDescription = 48;
+
+static string describeProduction(const Grammar& grammar, int production)
+{
+  string description;
+  for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr) {
+    if (!description.empty()) description += ' ';
+    if (Grammar::isTerminal(*curr))
+      description.append(grammar.getText(Grammar::getTerminalId(*curr)), grammar.getTextLength(Grammar::getTerminalId(*curr)));
+    else
+      description += grammar.getNameView(*curr);
+  }
+  if (description.empty()) return "(empty)";
+  if (description.size() > kMaxDescription) description = description.substr(0, kMaxDescription - 3) + "...";
+  return description;
+}
+
+/**
+ * Function: printProfile
+ * ----------------------
+ * Prints the profile of a run: a table of every nonterminal that was
+ * expanded, hottest first, followed by how often each production of every
+ * rule with a choice to make was chosen, next to how often it should be.
+ * Limits, which override choices that don't fit, are the usual reason for
+ * the two to differ.
+ *
+ * With fewer than kMinProfileSamples samples, the times are noise, so
+ * they're shown as "-" and the table is ordered by self tokens instead of
+ * self time.  Ties go to the nonterminal with the lower ID, which is the
+ * one the grammar mentions first.  The profile covers every sentence
+ * drawn, so when duplicates were thrown away the header says how many,
+ * and the per-sentence figures are per sentence drawn.
+ */
+
+static const int kMinProfileSamples = 100;
+
+static void printProfile(const Grammar& grammar, const ExpansionProfile& profile, long long numSentences,
+                         ostream& out)
+{
+  vector<int> order;
+  double runSeconds = 0;
+  long long runTokens = 0;
+  for (int nonterminal = 0; nonterminal < grammar.getNumNonterminals(); nonterminal++) {
+    if (profile.getExpansions(nonterminal) == 0) continue;
+    order.push_back(nonterminal);
+    runSeconds += profile.getSelfSeconds(nonterminal);
+    runTokens += profile.getSelfTokens(nonterminal);
+  }
+  bool timed = profile.getNumSamples() >= kMinProfileSamples && runSeconds > 0;
+  sort(order.begin(), order.end(), [&](int a, int b) {
+    if (timed && profile.getSelfSeconds(a) != profile.getSelfSeconds(b))
+      return profile.getSelfSeconds(a) > profile.getSelfSeconds(b);
+    if (profile.getSelfTokens(a) != profile.getSelfTokens(b)) return profile.getSelfTokens(a) > profile.getSelfTokens(b);
+    if (profile.getTotalTokens(a) != profile.getTotalTokens(b)) return profile.getTotalTokens(a) > profile.getTotalTokens(b);
+    return a < b;
+  });
+
+  long long numDrawn = profile.getNumSentences();
+  out << "Profile of " << numSentences << " sentences";
+  if (numDrawn > numSentences) out << " and " << numDrawn - numSentences << " duplicates thrown away";
+  out << " (times sampled every " << ExpansionProfile::kSampleInterval << " symbols on average):" << endl;
+  out << "  " << left << setw(32) << "nonterminal" << right << setw(12) << "expansions" << setw(10) << "per sent."
+      << setw(13) << "self tokens" << setw(14) << "total tokens" << setw(10) << "self ms"
+      << setw(8) << "self %" << setw(9) << "total %" << endl;
+  for (size_t i = 0; i < order.size(); i++) {
+    int nonterminal = order[i];
+    double selfSeconds = profile.getSelfSeconds(nonterminal), totalSeconds = profile.getTotalSeconds(nonterminal);
+    out << "  " << left << setw(32) << grammar.getName(nonterminal) << right << fixed
+        << setw(12) << profile.getExpansions(nonterminal)
+        << setprecision(2) << setw(10) << (double) profile.getExpansions(nonterminal) / max(numDrawn, 1LL)
+        << setw(13) << profile.getSelfTokens(nonterminal) << setw(14) << profile.getTotalTokens(nonterminal)
+        << setprecision(1);
+    if (timed) {
+      out << setw(10) << selfSeconds * 1000 << setw(8) << 100 * selfSeconds / runSeconds
+          << setw(9) << 100 * totalSeconds / runSeconds << endl;
+    } else {
+      out << setw(10) << "-" << setw(8) << "-" << setw(9) << "-" << endl;
+    }
+  }
+  out << "  " << runTokens << " tokens in all, " << setprecision(1) << runSeconds * 1000 << " ms in "
+      << profile.getNumSamples() << (profile.getNumSamples() == 1 ? " sample" : " samples");
+  if (!timed) out << ", too few to time anything; profile more sentences for times";
+  out << "." << endl;
+
+  out << endl << "Production choices (chosen % vs. expected %):" << endl;
+  vector<double> probabilities;
+  for (size_t i = 0; i < order.size(); i++) {
+    int nonterminal = order[i];
+    const Grammar::Span& rule = grammar.getRule(nonterminal);
+    if (rule.length < 2) continue;
+    grammar.getProductionProbabilities(nonterminal, probabilities);
+    out << "  " << grammar.getName(nonterminal) << endl;
+    for (int production = rule.start; production < rule.start + rule.length; production++) {
+      double chosen = 100.0 * profile.getChoices(production) / profile.getExpansions(nonterminal);
+      out << "    " << setprecision(1) << setw(6) << chosen << setw(8) << 100 * probabilities[production - rule.start]
+          << "   " << describeProduction(grammar, production) << endl;
+    }
+  }
+}
+
+/**
+ * Function: loadGrammar
+ * ---------------------
+ * Produces the compiled Grammar for the specified file, which may be
+ * either a text grammar (which is mapped and tokenized in place, see
+ * grammar-parser.h) or a binary image written by rsg --compile (which is
+ * mapped and used as is, with no parsing at all).
+ *
+ * @return the Grammar, which the caller must delete, or NULL if the
+ *         file couldn't be opened or isn't a well formed image.
+ */
+
+static Grammar *loadGrammar(const char *file, ostream& chatter)
+{
+  if (Grammar::isImageFile(file)) {
+    Grammar *grammar = new Grammar(string(file));
+    if (!grammar->good()) {
+      cerr << "The grammar image named \"" << file << "\" is truncated, corrupt, or "
+           << "was compiled by a different version of rsg.  Recompile it from its grammar file." << endl;
+      delete grammar;
+      return NULL;
+    }
+    chatter << "The grammar image called \"" << file << "\" contains "
+            << grammar->getNumNonterminals() << " nonterminals." << endl;
+    return grammar;
+  }
+
+  GrammarBuilder builder;
+  if (!parseGrammarFile(file, builder)) {
+    cerr << "Failed to open the file named \"" << file << "\".  Check to ensure the file exists. " << endl;
+    return NULL;
+  }
+  
+  // things are looking good...
+  chatter << "The grammar file called \"" << file << "\" contains "
+          << builder.getNumDefinitions() << " definitions." << endl;
+  return new Grammar(builder);
+}
+
+/**
+ * Function: optimizeLoadedGrammar
+ * -------------------------------
+ * Replaces the specified grammar with its optimized form, reporting how
+ * much smaller it got.  A grammar without a <start> to optimize from is
+ * returned as is.
+ *
+ * @return the Grammar to use from now on, which the caller must delete.
+ */
+
+static Grammar *optimizeLoadedGrammar(Grammar *grammar, ostream& chatter)
+{
+  GrammarBuilder builder;
+  if (!optimizeGrammar(*grammar, grammar->getNonterminal("<start>"), builder)) return grammar;
+  Grammar *optimized = new Grammar(builder);
+  chatter << "Optimized the grammar from " << grammar->getNumNonterminals() << " nonterminals and "
+          << grammar->getNumProductions() << " productions to " << optimized->getNumNonterminals()
+          << " and " << optimized->getNumProductions() << "." << endl;
+  delete grammar;
+  return optimized;
+}
+
  /**
  * Performs the rudimentary error checking needed to confirm that
- * the client provided a grammar file.  It then continues to
- * open the file, read the grammar into a map<string, Definition>,
- * and then print out the total number of Definitions that were read
- * in.  You're to update and decompose the main function to print
- * three randomly generated sentences, as illustrated by the sample
- * application.
+ * the client provided a grammar file, then loads the grammar (parsing a
+ * text grammar exactly once, or mapping an image written by --compile)
+ * and compiles, analyzes, emits or generates from it as the options ask.
+ * Options says what each flag sets, and what it does is documented
+ * where it's implemented: generateSentences and Workload cover the
+ * threads and seeds, Expander::setLimits the limits, and
+ * grammar-analysis.h, grammar-optimizer.h, grammar-emitter.h,
+ * sentence-counter.h, length-table.h, fingerprinter.h and
+ * expansion-profile.h the rest.
+ *
+ * Usage: rsg --compile [--optimize] <path to grammar text file> <path to image file>
+ *        rsg --analyze [--optimize] <path to grammar text or image file>
+ *        rsg --emit-cpp [--optimize] [--output FILE] <path to grammar text or image file>
+ *        rsg [--count N | --unique N] [--output FILE] [--threads N] [--unordered] [--seed N]
+ *            [--counter-based] [--first N] [--max-depth N] [--max-tokens N]
+ *            [--optimize] [--uniform N] [--length N | --length MIN-MAX]
+ *            [--profile] <path to grammar text or image file>
+ *
+ * Exits with 1 for a malformed command line, 2 if a file can't be loaded
+ * or created, 3 if the grammar can't generate what was asked of it, and
+ * 4 if the output couldn't be written.
  *
  * @param argc the number of tokens making up the command that invoked
- *   		   the RSG executable.  There must be at least two arguments,
- *             and only the first two are used.
+ *   		   the RSG executable.
  * @param argv the sequence of tokens making up the command, where each
  *             token is represented as a '\0'-terminated C string.
  */
  
 int main(int argc, char *argv[])
 {
+  Options options;
   if (argc == 1) {
     cerr << "You need to specify the name of a grammar file." << endl;
-    cerr << "Usage: rsg <path to grammar text file>" << endl;
+    cerr << kUsage << endl;
     return 1; // non-zero return value means something bad happened 
   }
-  
-  ifstream grammarFile(argv[1]);
-  if (grammarFile.fail()) {
-    cerr << "Failed to open the file named \"" << argv[1] << "\".  Check to ensure the file exists. " << endl;
-    return 2; // each bad thing has its own bad return value
+  if (!parseOptions(argc, argv, options)) {
+    cerr << kUsage << endl;
+    return 1;
   }
   
-  // things are looking good...
-  map<string, Definition> grammar;
-  readGrammar(grammarFile, grammar);
-  cout << "The grammar file called \"" << argv[1] << "\" contains "
-       << grammar.size() << " definitions." << endl;
-  
-  string s = "<start>"; 
-  vector<string> output; 
-  output.push_back(s); 
+  ostream& chatter = options.bulk ? cerr : cout;
+  Grammar *grammar = loadGrammar(options.grammarFile, chatter);
+  if (grammar == NULL) return 2; // each bad thing has its own bad return value
+  if (options.optimize) grammar = optimizeLoadedGrammar(grammar, chatter);
+  const Grammar& compiled = *grammar;
+
+  if (options.compile) {
+    bool saved = compiled.save(options.imageFile);
+    delete grammar;
+    if (!saved) {
+      cerr << "Failed to write the grammar image named \"" << options.imageFile << "\"." << endl;
+      return 2;
+    }
+    cout << "Compiled \"" << options.grammarFile << "\" into \"" << options.imageFile << "\"." << endl;
+    return 0;
+  }
+
+  if (!options.seeded) options.seed = RandomGenerator().next();
+  int start = compiled.getNonterminal("<start>");
+  GrammarAnalysis analysis(compiled, start);
+  if (options.analyze) {
+    printAnalysis(compiled, analysis, start, cout);
+    delete grammar;
+    return 0;
+  }
+  if (start == -1 || !analysis.isDefined(start)) {
+    cerr << "The grammar doesn't define <start>, so there's nothing to generate." << endl;
+    delete grammar;
+    return 3;
+  }
+  if (!analysis.canTerminate(start)) {
+    cerr << "Every expansion of <start> leads to more nonterminals, so it can never finish.  "
+         << "Run rsg --analyze for details." << endl;
+    delete grammar;
+    return 3;
+  }
+  if (options.maxTokens < analysis.getMinTokens(start)) {
+    cerr << "<start> has no derivations of at most " << options.maxTokens << " tokens; the "
+         << "shortest has " << analysis.getMinTokens(start) << "." << endl;
+    delete grammar;
+    return 3;
+  }
+  bool limited = options.maxDepth != INT_MAX || options.maxTokens != LLONG_MAX ||
+    options.uniformTokens != -1 || options.minLength != -1;
+  if (analysis.getExpectedTokens(start) == HUGE_VAL && !limited)
+    cerr << "Warning: the expected length of a sentence is unbounded, so generation may not finish." << endl;
+
+  if (options.emitCpp) {
+    ofstream file;
+    if (options.outputFile != NULL) file.open(options.outputFile);
+    ostream& out = options.outputFile != NULL ? file : cout;
+    bool emitted = emitGeneratorSource(compiled, analysis, start, options.grammarFile, out);
+    if (file.is_open()) file.close();
+    delete grammar;
+    if (!emitted || file.fail()) {
+      cerr << "Failed to write the generator source." << endl;
+      return 4;
+    }
+    return 0;
+  }
+
+  SentenceCounter *counter = NULL;
+  if (options.uniformTokens != -1) {
+    counter = new SentenceCounter(compiled, analysis, options.uniformTokens);
+    if (!counter->good() || counter->getTotal(start).isZero()) {
+      if (!counter->good())
+        cerr << "Some nonterminal can derive itself without producing a token, so there are "
+             << "infinitely many derivations to sample from." << endl;
+      else
+        cerr << "<start> has no derivations of at most " << options.uniformTokens << " tokens; the "
+             << "shortest has " << analysis.getMinTokens(start) << "." << endl;
+      delete counter;
+      delete grammar;
+      return 3;
+    }
+    chatter << "<start> has " << counter->getTotal(start).toString() << " derivations of at most "
+            << options.uniformTokens << " tokens." << endl;
+  }
 
-  int count = 0; 
-  while ( lsearch(output,"<") != -1){
-    expandText(output, grammar); 
-    count++; 
+  LengthTable *table = NULL;
+  if (options.minLength != -1) {
+    table = new LengthTable(compiled, analysis, options.maxLength);
+    int numLengths = 0;
+    for (int length = options.minLength; length <= options.maxLength; length++)
+      if (table->derives(start, length)) numLengths++;
+    if (numLengths == 0) {
+      cerr << "<start> has no derivations of " << options.minLength;
+      if (options.maxLength != options.minLength) cerr << " to " << options.maxLength;
+      cerr << " tokens";
+      if (analysis.getMinTokens(start) > options.maxLength)
+        cerr << "; the shortest has " << analysis.getMinTokens(start);
+      cerr << "." << endl;
+      delete table;
+      delete grammar;
+      return 3;
+    }
+    chatter << "<start> can have " << numLengths << " of the " << options.maxLength - options.minLength + 1
+            << " lengths from " << options.minLength << " to " << options.maxLength << " tokens." << endl;
   }
 
-  for (int i = 0; i < output.size(); i++)
-    cout << output[i] << " " ; 
+  int fd = STDOUT_FILENO;
+  if (options.outputFile != NULL) {
+    fd = open(options.outputFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+      cerr << "Failed to open the file named \"" << options.outputFile << "\" for writing." << endl;
+      delete counter;
+      delete table;
+      delete grammar;
+      return 2;
+    }
+  }
 
+  ExpansionProfile *profile = options.profile ? new ExpansionProfile(compiled) : NULL;
+  long long numSentences;
+  bool ok = generateSentences(compiled, analysis, counter, table, start, fd, options, profile, numSentences);
+  if (options.outputFile != NULL && close(fd) == -1) ok = false;
+  if (profile != NULL) {
+    if (!options.bulk) cout.flush();
+    printProfile(compiled, *profile, numSentences, chatter);
+    delete profile;
+  }
+  delete counter;
+  delete table;
+  delete grammar;
+  if (!ok) {
+    cerr << "Failed to write all of the generated sentences." << endl;
+    return 4;
+  }
+  if (numSentences < options.count) {
+    cerr << "Gave up after " << kMaxDuplicateRun << " duplicates in a row, so <start> probably has "
+         << "fewer than " << options.count << " distinct sentences." << endl;
+    return 3;
+  }
   return 0;
 }
@@ -0,0 +1,136 @@
+/**
+ * File: sentence-counter.cc
+ * -------------------------
+ * Provides the implementation of the SentenceCounter class.
+ */
+
+#include "sentence-counter.h"
+
+static const BigInt kZero(0);
+static const BigInt kOne(1);
+
+/**
+ * Constructor: SentenceCounter
+ * ----------------------------
+ * Only the live nonterminals (reachable, defined, and able to terminate)
+ * get tables; every other nonterminal has no derivations of any length.
+ * A nonterminal A depends on B within a single length if one of A's
+ * productions has B with nothing but nullable symbols on either side of
+ * it, and the live nonterminals are put in dependency order with Kahn's
+ * algorithm.  Each length is then done in two passes: the first finds
+ * every count in dependency order, and the second redoes every suffix,
+ * since a suffix whose symbols are preceded by a token can depend on
+ * counts of this length that the first pass hadn't reached yet.
+ */
+
+SentenceCounter::SentenceCounter(const Grammar& grammar, const GrammarAnalysis& analysis, int maxTokens) :
+  grammar(grammar), maxTokens(maxTokens), finite(false)
+{
+  int numNonterminals = grammar.getNumNonterminals();
+  int width = maxTokens + 1;
+  vector<int> live;
+  liveIndex.assign(numNonterminals, -1);
+  suffixStart.assign(grammar.getNumProductions(), -1);
+  size_t numSuffixes = 0;
+  for (int nonterminal = 0; nonterminal < numNonterminals; nonterminal++) {
+    if (!analysis.isReachable(nonterminal) || !analysis.isDefined(nonterminal) ||
+        !analysis.canTerminate(nonterminal)) continue;
+    liveIndex[nonterminal] = live.size();
+    live.push_back(nonterminal);
+    const Grammar::Span& rule = grammar.getRule(nonterminal);
+    for (int production = rule.start; production < rule.start + rule.length; production++) {
+      suffixStart[production] = numSuffixes;
+      numSuffixes += (size_t) (grammar.getSymbolsEnd(production) - grammar.getSymbols(production)) * width;
+    }
+  }
+
+  vector<int> numDependencies(live.size(), 0);
+  vector<vector<int> > dependents(live.size());
+  for (size_t i = 0; i < live.size(); i++) {
+    const Grammar::Span& rule = grammar.getRule(live[i]);
+    for (int production = rule.start; production < rule.start + rule.length; production++) {
+      int numConsuming = 0;
+      for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr)
+        if (isText(*curr) || liveIndex[*curr] == -1 || analysis.getMinTokens(*curr) > 0) numConsuming++;
+      for (const int *curr = grammar.getSymbols(production); curr != grammar.getSymbolsEnd(production); ++curr) {
+        if (isText(*curr) || liveIndex[*curr] == -1) continue;
+        bool nullable = analysis.getMinTokens(*curr) == 0;
+        if (numConsuming - (nullable ? 0 : 1) > 0) continue;
+        dependents[liveIndex[*curr]].push_back(i);
+        numDependencies[i]++;
+      }
+    }
+  }
+  vector<int> order;
+  for (size_t i = 0; i < live.size(); i++)
+    if (numDependencies[i] == 0) order.push_back(i);
+  for (size_t next = 0; next < order.size(); next++)
+    for (size_t k = 0; k < dependents[order[next]].size(); k++)
+      if (--numDependencies[dependents[order[next]][k]] == 0) order.push_back(dependents[order[next]][k]);
+  if (order.size() < live.size()) return;
+  finite = true;
+
+  counts.resize(live.size() * width);
+  suffixes.resize(numSuffixes);
+  for (int length = 0; length <= maxTokens; length++) {
+    for (size_t i = 0; i < order.size(); i++) {
+      int nonterminal = live[order[i]];
+      const Grammar::Span& rule = grammar.getRule(nonterminal);
+      BigInt& count = counts[order[i] * width + length];
+      for (int production = rule.start; production < rule.start + rule.length; production++) {
+        countSuffixes(production, length);
+        count += getSuffix(production, 0, length);
+      }
+    }
+    for (int production = 0; production < grammar.getNumProductions(); production++)
+      if (suffixStart[production] != -1) countSuffixes(production, length);
+  }
+
+  totals.resize(live.size());
+  for (size_t i = 0; i < live.size(); i++)
+    for (int length = 0; length <= maxTokens; length++) totals[i] += counts[i * width + length];
+}
+
+/**
+ * Method: countSuffixes
+ * ---------------------
+ * Fills in suffix(p, i, length) for each of the production's symbols from
+ * right to left.  A text symbol always accounts for the same number of
+ * tokens, so its suffix is just the next one over, shifted by that many.
+ */
+
+void SentenceCounter::countSuffixes(int production, int length)
+{
+  const int *symbols = grammar.getSymbols(production);
+  int numSymbols = grammar.getSymbolsEnd(production) - symbols;
+  for (int i = numSymbols - 1; i >= 0; i--) {
+    BigInt& suffix = suffixAt(production, i, length);
+    if (isText(symbols[i])) {
+      int numTokens = grammar.getTokenCount(symbols[i]);
+      suffix = length >= numTokens ? getSuffix(production, i + 1, length - numTokens) : kZero;
+      continue;
+    }
+    suffix = 0;
+    for (int j = 0; j <= length; j++)
+      suffix.addProduct(getCount(symbols[i], j), getSuffix(production, i + 1, length - j));
+  }
+}
+
+const BigInt& SentenceCounter::getCount(int symbol, int length) const
+{
+  if (isText(symbol)) return length == grammar.getTokenCount(symbol) ? kOne : kZero;
+  if (liveIndex[symbol] == -1) return kZero;
+  return counts[liveIndex[symbol] * (maxTokens + 1) + length];
+}
+
+const BigInt& SentenceCounter::getTotal(int nonterminal) const
+{
+  return liveIndex[nonterminal] == -1 ? kZero : totals[liveIndex[nonterminal]];
+}
+
+const BigInt& SentenceCounter::getSuffix(int production, int i, int length) const
+{
+  if (i == grammar.getSymbolsEnd(production) - grammar.getSymbols(production))
+    return length == 0 ? kOne : kZero;
+  return suffixes[suffixStart[production] + i * (maxTokens + 1) + length];
+}
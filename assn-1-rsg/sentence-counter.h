@@ -0,0 +1,152 @@
+#ifndef __sentence_counter__
+#define __sentence_counter__
+
+/**
+ * File: sentence-counter.h
+ * ------------------------
+ * Defines the SentenceCounter class, which counts exactly how many
+ * distinct derivations each nonterminal has of each length up to a
+ * bound, and uses those counts to sample derivations uniformly.
+ *
+ * Choosing each production uniformly (as getRandomProduction does)
+ * strongly favors short derivations: a rule with one terminal production
+ * and one recursive production picks the terminal half the time, however
+ * many more sentences the recursive one leads to.  Sampling in proportion
+ * to the counts instead makes every derivation of at most maxTokens tokens
+ * equally likely.  For an unambiguous grammar, where every sentence has
+ * exactly one derivation, that's a uniform sample of the sentences.
+ * Production weights play no part.
+ *
+ * With count(A, n) the number of derivations of A with n tokens, the
+ * counts satisfy
+ *
+ *    count(A, n) = the sum over A's productions p of suffix(p, 0, n),
+ *    suffix(p, i, n) = the sum over j of count(s_i, j) * suffix(p, i + 1, n - j),
+ *
+ * where s_i is p's ith symbol, a terminal (or undefined nonterminal) has a
+ * single derivation, whose length is its token count (see
+ * Grammar::getTokenCount), and the suffix past p's last symbol has a
+ * single derivation of length 0.  The tables are filled one length at a
+ * time, each length in an order in which the nonterminals that can derive
+ * each other without consuming a token come first.  If there's no such
+ * order, some nonterminal can derive itself without consuming a token,
+ * which gives it infinitely many derivations, and the counter isn't good.
+ *
+ * The tables are built once, in time proportional to the number of
+ * symbols times maxTokens squared, and are only read afterwards, so one
+ * SentenceCounter serves any number of Expanders on any number of threads.
+ */
+
+#include "grammar.h"
+#include "grammar-analysis.h"
+#include "big-int.h"
+#include <vector>
+using namespace std;
+
+class SentenceCounter {
+
+ public:
+
+  /**
+   * Constructor: SentenceCounter
+   * ----------------------------
+   * Counts the derivations of every nonterminal the analysis found to be
+   * reachable, defined and able to terminate, up to the specified length.
+   * The grammar and analysis must outlive the counter.
+   */
+
+  SentenceCounter(const Grammar& grammar, const GrammarAnalysis& analysis, int maxTokens);
+
+  /**
+   * Method: good
+   * ------------
+   * Returns false if some nonterminal can derive itself without consuming
+   * a token, in which case the counts are infinite and none were computed.
+   */
+
+  bool good() const { return finite; }
+
+  int getMaxTokens() const { return maxTokens; }
+
+  /**
+   * Methods: getCount, getTotal
+   * ---------------------------
+   * Return the number of derivations of the specified symbol with exactly
+   * the specified number of tokens, and the number of derivations of the
+   * specified nonterminal with at most maxTokens tokens.
+   */
+
+  const BigInt& getCount(int symbol, int length) const;
+  const BigInt& getTotal(int nonterminal) const;
+
+  /**
+   * Methods: chooseLength, chooseProduction, chooseSplit
+   * ----------------------------------------------------
+   * The three steps of sampling a derivation uniformly, from the top down:
+   * chooseLength picks the length of the whole derivation of a nonterminal,
+   * chooseProduction picks the production that derivation starts with, and
+   * chooseSplit picks how many of a production's remaining tokens come from
+   * its ith symbol, given that symbols i onward account for length tokens.
+   * Each choice is made in proportion to the number of derivations it
+   * leaves, by drawing one BigInt below the total and walking the
+   * candidates until it falls within one.  scratch and term are working
+   * space, passed in so that sampling needn't allocate.
+   */
+
+  template <class Generator>
+  int chooseLength(int nonterminal, Generator& random, BigInt& scratch) const
+  {
+    scratch.setRandomBelow(getTotal(nonterminal), random);
+    for (int length = 0; length < maxTokens; length++) {
+      const BigInt& count = getCount(nonterminal, length);
+      if (scratch < count) return length;
+      scratch -= count;
+    }
+    return maxTokens;
+  }
+
+  template <class Generator>
+  int chooseProduction(int nonterminal, int length, Generator& random, BigInt& scratch) const
+  {
+    const Grammar::Span& rule = grammar.getRule(nonterminal);
+    scratch.setRandomBelow(getCount(nonterminal, length), random);
+    for (int production = rule.start; production < rule.start + rule.length - 1; production++) {
+      const BigInt& count = getSuffix(production, 0, length);
+      if (scratch < count) return production;
+      scratch -= count;
+    }
+    return rule.start + rule.length - 1;
+  }
+
+  template <class Generator>
+  int chooseSplit(int production, int i, int length, Generator& random, BigInt& scratch, BigInt& term) const
+  {
+    int symbol = grammar.getSymbols(production)[i];
+    if (isText(symbol)) return grammar.getTokenCount(symbol);
+    scratch.setRandomBelow(getSuffix(production, i, length), random);
+    for (int j = 0; j < length; j++) {
+      term = 0;
+      term.addProduct(getCount(symbol, j), getSuffix(production, i + 1, length - j));
+      if (scratch < term) return j;
+      scratch -= term;
+    }
+    return length;
+  }
+
+ private:
+  const Grammar& grammar;
+  int maxTokens;
+  bool finite;
+  vector<int> liveIndex;
+  vector<BigInt> counts;
+  vector<BigInt> totals;
+  vector<long long> suffixStart;
+  vector<BigInt> suffixes;
+
+  bool isText(int symbol) const { return Grammar::isTerminal(symbol) || grammar.getRule(symbol).length == 0; }
+  const BigInt& getSuffix(int production, int i, int length) const;
+  BigInt& suffixAt(int production, int i, int length) { return suffixes[suffixStart[production] + i * (maxTokens + 1) + length]; }
+  void countSuffixes(int production, int length);
+};
+
+#endif // ! __sentence_counter__
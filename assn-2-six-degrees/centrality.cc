@@ -0,0 +1,329 @@
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <chrono>
+#include "imdb.h"
+using namespace std;
+
+/**
+ * File: centrality.cc
+ * -------------------
+ * Analytics tool that computes degree statistics for every actor in the
+ * imdb along with approximate betweenness centrality, and prints a ranked
+ * table of the most central actors.
+ *
+ * Betweenness is estimated with Brandes' algorithm run from a random sample
+ * of source actors.  The searches run over the bipartite actor/movie graph
+ * (so large casts don't explode into quadratically many actor-actor edges),
+ * and only actors are counted as path endpoints and intermediaries.
+ * Sources are split across worker threads, each of which owns its own
+ * search state and betweenness accumulator, and the accumulators are
+ * summed once all threads have finished.
+ */
+
+/**
+ * Struct: actorGraph
+ * ------------------
+ * Compressed sparse row copy of the imdb's credits and casts, indexed
+ * by dense actor and movie IDs.  The credits of actor a are
+ * movies[creditStart[a]] through movies[creditStart[a + 1] - 1], and
+ * the cast of movie m is actors[castStart[m]] through actors[castStart[m + 1] - 1].
+ * Built once so that the many searches never touch the data files.
+ */
+
+struct actorGraph {
+  int numActors;
+  int numMovies;
+  vector<int> creditStart;
+  vector<int> movies;
+  vector<int> castStart;
+  vector<int> actors;
+};
+
+/**
+ * Function: buildGraph
+ * --------------------
+ * Copies the credits out of the imdb and then transposes them (with
+ * a counting sort) to get the casts, so each cast list needn't be
+ * located and translated separately.
+ */
+
+static void buildGraph(const imdb& db, actorGraph& graph)
+{
+  graph.numActors = db.getNumActors();
+  graph.numMovies = db.getNumMovies();
+  graph.creditStart.assign(graph.numActors + 1, 0);
+  graph.movies.clear();
+  vector<int> credits;
+  for (int actorId = 0; actorId < graph.numActors; actorId++) {
+    db.getCreditIds(actorId, credits);
+    graph.movies.insert(graph.movies.end(), credits.begin(), credits.end());
+    graph.creditStart[actorId + 1] = graph.movies.size();
+  }
+
+  graph.castStart.assign(graph.numMovies + 1, 0);
+  for (int i = 0; i < (int) graph.movies.size(); i++)
+    graph.castStart[graph.movies[i] + 1]++;
+  for (int movieId = 0; movieId < graph.numMovies; movieId++)
+    graph.castStart[movieId + 1] += graph.castStart[movieId];
+  graph.actors.resize(graph.movies.size());
+  vector<int> next(graph.castStart.begin(), graph.castStart.end() - 1);
+  for (int actorId = 0; actorId < graph.numActors; actorId++)
+    for (int i = graph.creditStart[actorId]; i < graph.creditStart[actorId + 1]; i++)
+      graph.actors[next[graph.movies[i]]++] = actorId;
+}
+
+/**
+ * Struct: workerState
+ * -------------------
+ * Everything one thread needs to run Brandes searches without sharing
+ * anything with other threads.  Nodes are numbered with actors first
+ * (IDs [0, numActors)) and movies after (numActors + movieId).
+ */
+
+struct workerState {
+  vector<int> distance;
+  vector<double> numPaths;
+  vector<double> dependency;
+  vector<int> order;
+  vector<double> betweenness;
+  vector<int> costarStamp;
+};
+
+/**
+ * Function: getNeighbors
+ * ----------------------
+ * Sets begin and end to delimit the neighbors of the specified node
+ * (the credits of an actor or the cast of a movie), and returns
+ * the amount that must be added to each entry to turn it into a node number.
+ */
+
+static int getNeighbors(const actorGraph& graph, int node, const int *& begin, const int *& end)
+{
+  if (node < graph.numActors) {
+    begin = graph.movies.data() + graph.creditStart[node];
+    end = graph.movies.data() + graph.creditStart[node + 1];
+    return graph.numActors;
+  }
+  int movieId = node - graph.numActors;
+  begin = graph.actors.data() + graph.castStart[movieId];
+  end = graph.actors.data() + graph.castStart[movieId + 1];
+  return 0;
+}
+
+/**
+ * Function: accumulateFrom
+ * ------------------------
+ * One round of Brandes' algorithm from the specified source actor.  The
+ * forward BFS counts shortest paths, and the backward sweep over the BFS
+ * order accumulates each node's dependency from its successors:
+ *
+ *    dependency[v] += numPaths[v] / numPaths[w] * (isActor(w) + dependency[w])
+ *
+ * Predecessors are rediscovered by checking distances rather than being stored.
+ */
+
+static void accumulateFrom(const actorGraph& graph, int source, workerState& state)
+{
+  const int numActors = graph.numActors;
+  state.order.clear();
+  state.distance[source] = 0;
+  state.numPaths[source] = 1;
+  state.order.push_back(source);
+
+  for (size_t head = 0; head < state.order.size(); head++) {
+    int node = state.order[head];
+    int nextDistance = state.distance[node] + 1;
+    const int *begin, *end;
+    int offset = getNeighbors(graph, node, begin, end);
+    for (const int *curr = begin; curr != end; ++curr) {
+      int neighbor = *curr + offset;
+      if (state.distance[neighbor] == -1) {
+        state.distance[neighbor] = nextDistance;
+        state.order.push_back(neighbor);
+      }
+      if (state.distance[neighbor] == nextDistance)
+        state.numPaths[neighbor] += state.numPaths[node];
+    }
+  }
+
+  for (int i = state.order.size() - 1; i >= 0; i--) {
+    int node = state.order[i];
+    double credit = ((node < numActors) ? 1.0 : 0.0) + state.dependency[node];
+    double share = credit / state.numPaths[node];
+    int previousDistance = state.distance[node] - 1;
+    const int *begin, *end;
+    int offset = getNeighbors(graph, node, begin, end);
+    for (const int *curr = begin; curr != end; ++curr) {
+      int neighbor = *curr + offset;
+      if (state.distance[neighbor] == previousDistance)
+        state.dependency[neighbor] += state.numPaths[neighbor] * share;
+    }
+    if (node < numActors && node != source)
+      state.betweenness[node] += state.dependency[node];
+  }
+
+  for (int i = 0; i < (int) state.order.size(); i++) {
+    int node = state.order[i];
+    state.distance[node] = -1;
+    state.numPaths[node] = 0;
+    state.dependency[node] = 0;
+  }
+}
+
+/**
+ * Function: runWorker
+ * -------------------
+ * Runs the Brandes rounds for sources[first], sources[first + stride], ...
+ * and counts the distinct costars of actors first, first + stride, ...
+ * Distinct costars are counted with a per-thread stamp array, so no
+ * set is ever built.
+ */
+
+static void runWorker(const actorGraph& graph, const vector<int>& sources, int first, int stride,
+                      workerState& state, vector<int>& numCostars)
+{
+  int numNodes = graph.numActors + graph.numMovies;
+  state.distance.assign(numNodes, -1);
+  state.numPaths.assign(numNodes, 0);
+  state.dependency.assign(numNodes, 0);
+  state.betweenness.assign(graph.numActors, 0);
+  state.costarStamp.assign(graph.numActors, -1);
+
+  for (int i = first; i < (int) sources.size(); i += stride)
+    accumulateFrom(graph, sources[i], state);
+
+  for (int actorId = first; actorId < graph.numActors; actorId += stride) {
+    int count = 0;
+    state.costarStamp[actorId] = actorId;
+    for (int i = graph.creditStart[actorId]; i < graph.creditStart[actorId + 1]; i++) {
+      int movieId = graph.movies[i];
+      for (int j = graph.castStart[movieId]; j < graph.castStart[movieId + 1]; j++) {
+        int costarId = graph.actors[j];
+        if (state.costarStamp[costarId] == actorId) continue;
+        state.costarStamp[costarId] = actorId;
+        count++;
+      }
+    }
+    numCostars[actorId] = count;
+  }
+}
+
+/**
+ * Function: printDegreeSummary
+ * ----------------------------
+ * Prints the minimum, median, mean and maximum of the specified
+ * per-actor statistic.
+ */
+
+static void printDegreeSummary(const string& label, vector<int> values)
+{
+  if (values.empty()) return;
+  sort(values.begin(), values.end());
+  double total = 0;
+  for (int i = 0; i < (int) values.size(); i++) total += values[i];
+  cout << setw(12) << label << ": min " << values.front() << ", median " << values[values.size() / 2]
+       << ", mean " << fixed << setprecision(2) << total / values.size()
+       << ", max " << values.back() << endl;
+}
+
+struct centralityOrder {
+  const vector<double> *betweenness;
+  bool operator()(int id1, int id2) const { return (*betweenness)[id1] > (*betweenness)[id2]; }
+};
+
+/**
+ * Serves as the main entry point for the centrality executable.
+ *
+ * Usage: centrality [--samples <n>] [--threads <n>] [--top <n>] [--seed <n>] [<data-directory>]
+ *
+ * --samples is the number of source actors Brandes' algorithm is run from
+ * (more samples, better estimates), --threads the number of worker threads
+ * (the hardware concurrency by default), and --top the number of actors
+ * listed in the ranked table.  The betweenness estimates are scaled up by
+ * numActors / samples and count each unordered pair of endpoints once.
+ */
+
+int main(int argc, const char *argv[])
+{
+  int numSamples = 1000;
+  int numThreads = thread::hardware_concurrency();
+  int numToPrint = 25;
+  unsigned int seed = 107;
+  const char *dataDirectory = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) numSamples = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) numThreads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) numToPrint = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoul(argv[++i], NULL, 10);
+    else if (argv[i][0] != '-') dataDirectory = argv[i];
+    else {
+      cerr << "Usage: centrality [--samples <n>] [--threads <n>] [--top <n>] [--seed <n>] "
+           << "[<data-directory>]" << endl;
+      return 1;
+    }
+  }
+  if (numThreads < 1) numThreads = 1;
+
+  imdb db(determinePathToData(dataDirectory)); // inlined in imdb-utils.h
+  if (!db.good()) {
+    cout << "Failed to properly initialize the imdb database." << endl;
+    cout << "Please check to make sure the source files exist and that you have permission to read them." << endl;
+    return 1;
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  actorGraph graph;
+  buildGraph(db, graph);
+
+  vector<int> sources(graph.numActors);
+  for (int i = 0; i < graph.numActors; i++) sources[i] = i;
+  mt19937 generator(seed);
+  shuffle(sources.begin(), sources.end(), generator);
+  if (numSamples < (int) sources.size()) sources.resize(max(numSamples, 0));
+
+  vector<workerState> states(numThreads);
+  vector<int> numCostars(graph.numActors);
+  vector<thread> workers;
+  for (int i = 0; i < numThreads; i++)
+    workers.push_back(thread(runWorker, cref(graph), cref(sources), i, numThreads,
+                             ref(states[i]), ref(numCostars)));
+  for (int i = 0; i < numThreads; i++) workers[i].join();
+
+  vector<double> betweenness(graph.numActors, 0);
+  double scale = sources.empty() ? 0 : 0.5 * graph.numActors / sources.size();
+  for (int i = 0; i < numThreads; i++)
+    for (int actorId = 0; actorId < graph.numActors; actorId++)
+      betweenness[actorId] += states[i].betweenness[actorId] * scale;
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  vector<int> numCredits(graph.numActors);
+  for (int actorId = 0; actorId < graph.numActors; actorId++)
+    numCredits[actorId] = graph.creditStart[actorId + 1] - graph.creditStart[actorId];
+  cout << graph.numActors << " actors, " << graph.numMovies << " movies, " << sources.size()
+       << " sampled sources, " << numThreads << " thread(s), " << fixed << setprecision(2)
+       << elapsed << " seconds." << endl;
+  printDegreeSummary("credits", numCredits);
+  printDegreeSummary("costars", numCostars);
+  cout << endl;
+
+  vector<int> ranked(graph.numActors);
+  for (int i = 0; i < graph.numActors; i++) ranked[i] = i;
+  numToPrint = min(max(numToPrint, 0), graph.numActors);
+  centralityOrder order = { &betweenness };
+  partial_sort(ranked.begin(), ranked.begin() + numToPrint, ranked.end(), order);
+
+  cout << setw(5) << "rank" << "  " << setw(16) << "betweenness" << "  " << setw(7) << "credits"
+       << "  " << setw(7) << "costars" << "  " << "name" << endl;
+  for (int i = 0; i < numToPrint; i++) {
+    int actorId = ranked[i];
+    cout << setw(5) << i + 1 << "  " << setw(16) << setprecision(1) << betweenness[actorId] << "  "
+         << setw(7) << numCredits[actorId] << "  " << setw(7) << numCostars[actorId] << "  "
+         << db.getActorName(actorId) << endl;
+  }
+  return 0;
+}
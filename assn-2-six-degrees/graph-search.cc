@@ -0,0 +1,77 @@
+#include "graph-search.h"
+#include <algorithm>
+using namespace std;
+
+/** Implementation note: findShortestPath
+ * -------------------------------------
+ * visited[node] has bit 0 set once the forward search has reached the node
+ * and bit 1 set once the backward search has, and parent[direction][node]
+ * is the node it was reached from in that direction.  Node numbers are
+ * actor IDs for actors and numActors + movie ID for movies.
+ */
+
+bool findShortestPath(const imdb& db, const graphNode& source, const graphNode& target,
+                      vector<graphNode>& nodes)
+{
+  nodes.clear();
+  if (source.id == -1 || target.id == -1) return false;
+  if (source == target) {
+    nodes.push_back(source);
+    return true;
+  }
+
+  const int numActors = db.getNumActors();
+  const int numNodes = numActors + db.getNumMovies();
+  vector<unsigned char> visited(numNodes, 0);
+  vector<int> parent[2] = { vector<int>(numNodes, -1), vector<int>(numNodes, -1) };
+  vector<int> frontier[2], next, neighbors;
+
+  int endpoints[2];
+  endpoints[0] = source.isMovie ? numActors + source.id : source.id;
+  endpoints[1] = target.isMovie ? numActors + target.id : target.id;
+  for (int direction = 0; direction < 2; direction++) {
+    visited[endpoints[direction]] |= 1 << direction;
+    frontier[direction].push_back(endpoints[direction]);
+  }
+
+  int meeting = -1;
+  while (meeting == -1 && !frontier[0].empty() && !frontier[1].empty()) {
+    int direction = (frontier[0].size() <= frontier[1].size()) ? 0 : 1;
+    next.clear();
+    for (int i = 0; i < (int) frontier[direction].size() && meeting == -1; i++) {
+      int node = frontier[direction][i];
+      int offset;
+      if (node < numActors) {
+        db.getCreditIds(node, neighbors);
+        offset = numActors;
+      } else {
+        db.getCastIds(node - numActors, neighbors);
+        offset = 0;
+      }
+      for (int j = 0; j < (int) neighbors.size(); j++) {
+        int neighbor = neighbors[j] + offset;
+        if (visited[neighbor] & (1 << direction)) continue;
+        visited[neighbor] |= 1 << direction;
+        parent[direction][neighbor] = node;
+        if (visited[neighbor] & (1 << (1 - direction))) {
+          meeting = neighbor;
+          break;
+        }
+        next.push_back(neighbor);
+      }
+    }
+    frontier[direction].swap(next);
+  }
+  if (meeting == -1) return false;
+
+  vector<int> numbered;
+  for (int node = meeting; node != -1; node = parent[0][node]) numbered.push_back(node);
+  reverse(numbered.begin(), numbered.end());
+  for (int node = parent[1][meeting]; node != -1; node = parent[1][node]) numbered.push_back(node);
+
+  for (int i = 0; i < (int) numbered.size(); i++) {
+    int node = numbered[i];
+    nodes.push_back(node < numActors ? graphNode(false, node) : graphNode(true, node - numActors));
+  }
+  return true;
+}
@@ -0,0 +1,51 @@
+#ifndef __graph_search__
+#define __graph_search__
+
+#include "imdb.h"
+#include <vector>
+using namespace std;
+
+/**
+ * Convenience struct: graphNode
+ * -----------------------------
+ * Names one node of the bipartite actor/movie graph: either the actor
+ * or the movie with the specified dense ID (see imdb::getActorId and
+ * imdb::getMovieId).
+ */
+
+struct graphNode {
+  bool isMovie;
+  int id;
+
+  graphNode() : isMovie(false), id(-1) {}
+  graphNode(bool isMovie, int id) : isMovie(isMovie), id(id) {}
+
+  bool operator==(const graphNode& rhs) const { return isMovie == rhs.isMovie && id == rhs.id; }
+  bool operator!=(const graphNode& rhs) const { return !(*this == rhs); }
+};
+
+/**
+ * Function: findShortestPath
+ * --------------------------
+ * Bidirectional breadth first search over the bipartite actor/movie graph.
+ * Either endpoint may be an actor or a movie, so actor-to-actor,
+ * movie-to-movie and mixed queries all run through the same search.
+ * Actors and movies share one dense node numbering (actors first, movies
+ * after) and one visited array, with a parent array per direction.  Each
+ * round expands whichever frontier is smaller, and the search stops at the
+ * first node discovered by both directions: since every meeting discovered
+ * while expanding one level has the same total length, the first one is a
+ * shortest path.
+ *
+ * @param db the imdb being searched.
+ * @param source the node the path starts at.
+ * @param target the node the path ends at.
+ * @param nodes updated to hold the path, source and target included, which
+ *              alternates between actors and movies.
+ * @return true if and only if some path connects source and target.
+ */
+
+bool findShortestPath(const imdb& db, const graphNode& source, const graphNode& target,
+                      vector<graphNode>& nodes);
+
+#endif
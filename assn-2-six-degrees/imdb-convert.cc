@@ -0,0 +1,219 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "imdb-format.h"
+#include "imdb-utils.h"
+using namespace std;
+
+/**
+ * File: imdb-convert.cc
+ * ---------------------
+ * Converts a pair of actordata and moviedata files into the portable
+ * format described in imdb-format.h.  The source files may be legacy
+ * (headerless) files or portable files in either byte order, and the
+ * converted files can be written in either byte order.  Since imdb reads
+ * portable files of either byte order, one converted data directory can
+ * serve every host.
+ */
+
+/**
+ * Function: hostIsLittleEndian
+ * ----------------------------
+ * Self-explanatory.
+ */
+
+static bool hostIsLittleEndian()
+{
+  const unsigned int one = 1;
+  return *(const unsigned char *) &one == 1;
+}
+
+/**
+ * Function: swapSection
+ * ---------------------
+ * Reverses the byte order of every multibyte field in the specified body:
+ * the record count, the offset table, and each record's two byte count
+ * and array of four byte offsets.  kSwapped describes the body's
+ * current byte order relative to the host, which is needed to make sense
+ * of the offsets before they're swapped.
+ *
+ * @return false if an offset or count points outside the body.
+ */
+
+template <bool kSwapped>
+static bool swapSection(char *body, size_t bodySize, int section)
+{
+  if (bodySize < sizeof(int)) return false;
+  int count = readInt<kSwapped>(body);
+  if (count < 0 || sizeof(int) * (count + 1) > bodySize) return false;
+
+  for (int i = 0; i < count; i++) {
+    int offset = readInt<kSwapped>(body + sizeof(int) * (i + 1));
+    if (offset < 0 || (size_t) offset >= bodySize) return false;
+    const char *record = body + offset;
+    const char *terminator = (const char *) memchr(record, '\0', bodySize - offset);
+    if (terminator == NULL) return false;
+
+    int prefix = terminator - record + 1;
+    if (section == kMovieSection) prefix++;
+    if (prefix % 2 != 0) prefix++;
+    if ((size_t) offset + prefix + sizeof(short) > bodySize) return false;
+    unsigned short numOffsets = readShort<kSwapped>(record + prefix);
+    unsigned short swappedCount = swapBytes(readShort<false>(record + prefix));
+    memcpy(body + offset + prefix, &swappedCount, sizeof(swappedCount));
+
+    prefix += sizeof(short);
+    if (prefix % 4 != 0) prefix += 2;
+    if ((size_t) offset + prefix + sizeof(int) * numOffsets > bodySize) return false;
+    for (int j = 0; j < numOffsets; j++) {
+      char *field = body + offset + prefix + sizeof(int) * j;
+      unsigned int value = swapBytes((unsigned int) readInt<false>(field));
+      memcpy(field, &value, sizeof(value));
+    }
+  }
+
+  for (int i = 0; i <= count; i++) {
+    unsigned int value = swapBytes((unsigned int) readInt<false>(body + sizeof(int) * i));
+    memcpy(body + sizeof(int) * i, &value, sizeof(value));
+  }
+  return true;
+}
+
+/**
+ * Function: convertSection
+ * ------------------------
+ * Reads the specified data file, strips any existing header, swaps the
+ * body into the requested byte order if necessary, and writes it back out
+ * behind a fresh header.
+ *
+ * @param sourceName the file being converted.
+ * @param destName the file being written.
+ * @param section kActorSection or kMovieSection.
+ * @param legacyLittleEndian the byte order assumed for headerless sources.
+ * @param littleEndian the byte order the converted file should use.
+ * @return true if and only if the conversion succeeded.
+ */
+
+static bool convertSection(const string& sourceName, const string& destName, int section,
+                           bool legacyLittleEndian, bool littleEndian)
+{
+  ifstream source(sourceName.c_str(), ios::binary);
+  if (source.fail()) {
+    cerr << "Failed to open \"" << sourceName << "\"." << endl;
+    return false;
+  }
+  vector<char> contents((istreambuf_iterator<char>(source)), istreambuf_iterator<char>());
+
+  bool sourceLittleEndian = legacyLittleEndian;
+  size_t bodyOffset = 0, bodySize = contents.size();
+  if (contents.size() >= sizeof(imdbFileHeader) && memcmp(&contents[0], kImdbMagic, sizeof(kImdbMagic)) == 0) {
+    imdbFileHeader header;
+    memcpy(&header, &contents[0], sizeof(header));
+    bool headerSwapped = header.byteOrderMark == kImdbSwappedByteOrderMark;
+    if (!headerSwapped && header.byteOrderMark != kImdbByteOrderMark) {
+      cerr << "\"" << sourceName << "\" has a corrupt header." << endl;
+      return false;
+    }
+    sourceLittleEndian = hostIsLittleEndian() != headerSwapped;
+    bodyOffset = headerSwapped ? swapBytes(header.bodyOffset) : header.bodyOffset;
+    bodySize = headerSwapped ? swapBytes(header.bodySize) : header.bodySize;
+    if (bodyOffset > contents.size() || bodySize > contents.size() - bodyOffset) {
+      cerr << "\"" << sourceName << "\" is truncated." << endl;
+      return false;
+    }
+  }
+
+  vector<char> body(contents.begin() + bodyOffset, contents.begin() + bodyOffset + bodySize);
+  if (body.size() < sizeof(int)) {
+    cerr << "\"" << sourceName << "\" is truncated." << endl;
+    return false;
+  }
+  bool sourceSwapped = sourceLittleEndian != hostIsLittleEndian();
+  if (sourceLittleEndian != littleEndian) {
+    bool swappedOk = sourceSwapped ? swapSection<true>(&body[0], body.size(), section)
+                                   : swapSection<false>(&body[0], body.size(), section);
+    if (!swappedOk) {
+      cerr << "\"" << sourceName << "\" isn't a well formed data file." << endl;
+      return false;
+    }
+  }
+
+  bool destSwapped = littleEndian != hostIsLittleEndian();
+  int recordCount = destSwapped ? readInt<true>(&body[0]) : readInt<false>(&body[0]);
+  imdbFileHeader header;
+  memcpy(header.magic, kImdbMagic, sizeof(kImdbMagic));
+  header.byteOrderMark = kImdbByteOrderMark;
+  header.version = kImdbFormatVersion;
+  header.section = section;
+  header.recordCount = recordCount;
+  header.offsetTableOffset = sizeof(int);
+  header.recordsOffset = sizeof(int) * (recordCount + 1);
+  header.bodyOffset = sizeof(header);
+  header.bodySize = body.size();
+  header.checksum = imdbChecksum(&body[0], body.size());
+  if (destSwapped) {
+    unsigned int *fields[] = { &header.byteOrderMark, &header.version, &header.section,
+                               &header.recordCount, &header.offsetTableOffset, &header.recordsOffset,
+                               &header.bodyOffset, &header.bodySize, &header.checksum };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+      *fields[i] = swapBytes(*fields[i]);
+  }
+
+  ofstream dest(destName.c_str(), ios::binary | ios::trunc);
+  dest.write((const char *) &header, sizeof(header));
+  dest.write(&body[0], body.size());
+  if (dest.fail()) {
+    cerr << "Failed to write \"" << destName << "\"." << endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Serves as the main entry point for the imdb-convert executable.
+ *
+ * Usage: imdb-convert [--order little|big|native] [--legacy-order little|big|native]
+ *                     <source-directory> <destination-directory>
+ *
+ * --order picks the byte order of the converted files (native by default), and
+ * --legacy-order says what byte order headerless source files are in (also
+ * native by default, which matches what imdb has always assumed).
+ */
+
+int main(int argc, const char *argv[])
+{
+  bool littleEndian = hostIsLittleEndian();
+  bool legacyLittleEndian = hostIsLittleEndian();
+  vector<string> directories;
+  bool usageError = false;
+  for (int i = 1; i < argc; i++) {
+    bool isOrder = strcmp(argv[i], "--order") == 0;
+    bool isLegacyOrder = strcmp(argv[i], "--legacy-order") == 0;
+    if ((isOrder || isLegacyOrder) && i + 1 < argc) {
+      bool& order = isOrder ? littleEndian : legacyLittleEndian;
+      string name = argv[++i];
+      if (name == "little") order = true;
+      else if (name == "big") order = false;
+      else if (name == "native") order = hostIsLittleEndian();
+      else usageError = true;
+    } else if (argv[i][0] != '-') {
+      directories.push_back(argv[i]);
+    } else {
+      usageError = true;
+    }
+  }
+  if (usageError || directories.size() != 2) {
+    cerr << "Usage: imdb-convert [--order little|big|native] [--legacy-order little|big|native] "
+         << "<source-directory> <destination-directory>" << endl;
+    return 1;
+  }
+
+  const string& source = directories[0];
+  const string& dest = directories[1];
+  if (!convertSection(source + "/actordata", dest + "/actordata", kActorSection, legacyLittleEndian, littleEndian) ||
+      !convertSection(source + "/moviedata", dest + "/moviedata", kMovieSection, legacyLittleEndian, littleEndian))
+    return 2;
+  return 0;
+}
@@ -0,0 +1,97 @@
+#ifndef __imdb_format__
+#define __imdb_format__
+
+#include <string.h>
+#include <stddef.h>
+
+/**
+ * File: imdb-format.h
+ * -------------------
+ * Describes the versioned, endian-neutral container for the actordata and
+ * moviedata files.  A portable data file is a fixed size header followed
+ * by a body that's byte for byte the legacy data file (a record count, the
+ * offset table, and the records themselves), written in whichever byte
+ * order the header advertises.  All offsets in the body remain relative
+ * to the start of the body.
+ *
+ * Legacy files have no header and are always read in the host's byte order.
+ * Portable files are validated once when the imdb opens them, after which
+ * readers use readInt<true> and readShort<true> if the file's byte order
+ * differs from the host's, and readInt<false> and readShort<false> otherwise.
+ * The swap decision is a template argument, so the native readers compile
+ * down to plain loads.
+ */
+
+static const char kImdbMagic[4] = { 'I', 'M', 'D', 'B' };
+static const unsigned int kImdbByteOrderMark = 0x01020304;
+static const unsigned int kImdbSwappedByteOrderMark = 0x04030201;
+static const unsigned int kImdbFormatVersion = 1;
+
+enum imdbSection { kActorSection = 1, kMovieSection = 2 };
+
+/**
+ * Struct: imdbFileHeader
+ * ----------------------
+ * Every field other than magic is stored in the file's byte order, and
+ * byteOrderMark reads back as kImdbByteOrderMark exactly when that order
+ * matches the host's.  Offsets within the body are relative to the body,
+ * and the checksum covers the bodySize bytes of the body.
+ */
+
+struct imdbFileHeader {
+  char magic[4];
+  unsigned int byteOrderMark;
+  unsigned int version;
+  unsigned int section;
+  unsigned int recordCount;
+  unsigned int offsetTableOffset;
+  unsigned int recordsOffset;
+  unsigned int bodyOffset;
+  unsigned int bodySize;
+  unsigned int checksum;
+};
+
+inline unsigned int swapBytes(unsigned int value) { return __builtin_bswap32(value); }
+inline unsigned short swapBytes(unsigned short value) { return __builtin_bswap16(value); }
+
+/**
+ * Functions: readInt, readShort
+ * -----------------------------
+ * Read a four byte int or two byte unsigned short from the specified
+ * address of a data file, swapping bytes if and only if kSwapped is true.
+ */
+
+template <bool kSwapped>
+inline int readInt(const void *ptr)
+{
+  unsigned int value;
+  memcpy(&value, ptr, sizeof(value));
+  return (int) (kSwapped ? swapBytes(value) : value);
+}
+
+template <bool kSwapped>
+inline unsigned short readShort(const void *ptr)
+{
+  unsigned short value;
+  memcpy(&value, ptr, sizeof(value));
+  return kSwapped ? swapBytes(value) : value;
+}
+
+/**
+ * Function: imdbChecksum
+ * ----------------------
+ * 32-bit FNV-1a hash of the specified bytes.
+ */
+
+inline unsigned int imdbChecksum(const void *data, size_t numBytes)
+{
+  const unsigned char *bytes = (const unsigned char *) data;
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < numBytes; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+#endif
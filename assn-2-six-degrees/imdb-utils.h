@@ -5,6 +5,8 @@
 #include <string.h>
 #include <iostream>
 #include <cstdlib> 
+#include <string>
+#include <unistd.h>
 using namespace std;
 
 /**
@@ -49,30 +51,29 @@ struct film {
 };
 
 /**
- * Quick, UNIX-dependent function to determine whether or not the
- * the resident OS is Linux or Solaris.  For our purposes, this
- * tells us whether the machine is big-endian or little-endian, and
- * the endiannees tells us which set of raw binary data files we should
- * be using.
+ * Quick, UNIX-dependent function to determine where the raw binary
+ * data files live.  A directory of portable data files (see imdb-format.h),
+ * which every host can read regardless of byte order, is preferred.
+ * Failing that, we fall back on the legacy little-endian or big-endian
+ * files, depending on the byte order of the machine we're running on.
  *
- * @return one of two data paths.
+ * @param userSelectedPath a directory to use instead, or NULL.
+ * @return one of the data paths.
  */
 
 inline const char *determinePathToData(const char *userSelectedPath = NULL)
 {
   if (userSelectedPath != NULL) return userSelectedPath;
-  
-  const char *ostype = getenv("OSTYPE");
-  if (strcasecmp(ostype, "linux") == 0)
+
+  const char *portablePath = "/home/compilers/cs107/assn-2-six-degrees-data/portable/";
+  if (access((string(portablePath) + "actordata").c_str(), R_OK) == 0 &&
+      access((string(portablePath) + "moviedata").c_str(), R_OK) == 0)
+    return portablePath;
+
+  const unsigned int one = 1;
+  if (*(const unsigned char *) &one == 1)
     return  "/home/compilers/cs107/assn-2-six-degrees-data/little-endian/"; 
-  if (strcasecmp(ostype, "solaris") == 0)
-    return "/home/compilers/cs107/assn-2-six-degrees-data/big-endian/"; 
-  
-  
-  
-  cerr << "Unsupported OS... bailing" << endl;
-  exit(1);
-  return NULL;
+  return "/home/compilers/cs107/assn-2-six-degrees-data/big-endian/"; 
 }
 
 #endif
@@ -4,7 +4,9 @@ using namespace std;
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <algorithm>
 #include "imdb.h"
+#include "imdb-format.h"
 
 /** Implementation notes: data format
  * ---------------------------------
@@ -49,7 +51,6 @@ using namespace std;
  * 
  * 				an array of offsets into the actorFile. Each offset represents and actors (i.e. the array 
  * 				represents the cast of the movie
- */ 
  * 	
  * 
  */
@@ -67,12 +68,74 @@ imdb::imdb(const string& directory)
   actorFile = acquireFileMap(actorFileName, actorInfo);
   movieFile = acquireFileMap(movieFileName, movieInfo);
 
+  bool actorsSwapped = false, moviesSwapped = false;
+  if (actorInfo.fd != -1) actorFile = openSection(actorInfo, kActorSection, actorsSwapped);
+  if (movieInfo.fd != -1) movieFile = openSection(movieInfo, kMovieSection, moviesSwapped);
+  valid = actorFile != NULL && movieFile != NULL && actorsSwapped == moviesSwapped;
+  swapped = actorsSwapped;
+
+  if (good()) {
+    if (swapped) {
+      buildIdsByOffset<true>(getActorOffsets(), getNumActors(), actorIdsByOffset);
+      buildIdsByOffset<true>(getMovieOffsets(), getNumMovies(), movieIdsByOffset);
+    } else {
+      buildIdsByOffset<false>(getActorOffsets(), getNumActors(), actorIdsByOffset);
+      buildIdsByOffset<false>(getMovieOffsets(), getNumMovies(), movieIdsByOffset);
+    }
+  }
 }
 
 bool imdb::good() const
 {
   return !( (actorInfo.fd == -1) || 
-	    (movieInfo.fd == -1) ); 
+	    (movieInfo.fd == -1) ) && valid; 
+}
+
+/** Implementation note: openSection
+ * ---------------------------------
+ * Legacy data files are the body and nothing else, in the host's byte order,
+ * and are accepted as is.  Portable files start with an imdbFileHeader,
+ * which is validated here, once, so that nothing downstream needs to
+ * check anything: the magic, byte order mark, version and section must be
+ * what we expect, the body must fit in the file and agree with the header's
+ * counts and section offsets, and the body's checksum must match.
+ *
+ * @return the address of the body, or NULL if the header is invalid.
+ */
+
+const void *imdb::openSection(const fileInfo& info, int section, bool& swapped)
+{
+  const char *fileMap = (const char *) info.fileMap;
+  if (info.fileSize < sizeof(int)) return NULL;
+  if (info.fileSize < sizeof(imdbFileHeader) || memcmp(fileMap, kImdbMagic, sizeof(kImdbMagic)) != 0) {
+    swapped = false;
+    return fileMap;
+  }
+
+  imdbFileHeader header;
+  memcpy(&header, fileMap, sizeof(header));
+  if (header.byteOrderMark == kImdbByteOrderMark) swapped = false;
+  else if (header.byteOrderMark == kImdbSwappedByteOrderMark) swapped = true;
+  else return NULL;
+
+  unsigned int *fields[] = { &header.version, &header.section, &header.recordCount,
+                             &header.offsetTableOffset, &header.recordsOffset,
+                             &header.bodyOffset, &header.bodySize, &header.checksum };
+  if (swapped)
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+      *fields[i] = swapBytes(*fields[i]);
+
+  if (header.version != kImdbFormatVersion || header.section != (unsigned int) section) return NULL;
+  if (header.bodyOffset < sizeof(header) || header.bodyOffset % sizeof(int) != 0 ||
+      header.bodyOffset > info.fileSize || header.bodySize > info.fileSize - header.bodyOffset) return NULL;
+  const char *body = fileMap + header.bodyOffset;
+  if (header.offsetTableOffset != sizeof(int) ||
+      header.recordsOffset != sizeof(int) * (header.recordCount + 1) ||
+      header.recordsOffset > header.bodySize) return NULL;
+  unsigned int recordCount = swapped ? readInt<true>(body) : readInt<false>(body);
+  if (recordCount != header.recordCount) return NULL;
+  if (imdbChecksum(body, header.bodySize) != header.checksum) return NULL;
+  return body;
 }
 
 
@@ -98,6 +161,7 @@ bool imdb::good() const
  *             representing an actor's name, thus allowing a string-to-string 
  * 			   comparison
  */ 
+template <bool kSwapped>
 int imdb::nameCmp(const void *vp1, const void *vp2) { 
  
   /* the first arg is a referece to the search pair struct
@@ -109,10 +173,10 @@ int imdb::nameCmp(const void *vp1, const void *vp2) {
   const char *name1 = sp->playerName;
   
   /* the second arg is a pointer to an integer offset 
-   * we immediately cast to (int*) and dereference the offset
+   * we read it in the data file's byte order
    */ 
 
-  int offset = *(int*)vp2;
+  int offset = readInt<kSwapped>(vp2);
 
   /*using the offset we get a pointer to the actor record
    *the first element of the record is the actor name*/ 
@@ -143,7 +207,13 @@ int imdb::nameCmp(const void *vp1, const void *vp2) {
  */ 
 
 
-bool imdb::getCredits(const string& player, vector<film>& films) const { 
+bool imdb::getCredits(const string& player, vector<film>& films) const
+{
+  return swapped ? readCredits<true>(player, films) : readCredits<false>(player, films);
+}
+
+template <bool kSwapped>
+bool imdb::readCredits(const string& player, vector<film>& films) const { 
   /* the first step is to use binary search to find the player record 
    * in the actorfile
    */ 
@@ -153,7 +223,7 @@ bool imdb::getCredits(const string& player, vector<film>& films) const {
    * the first element of the data is a 4 byte integer 
    * Store away the number of actors.
    */
-  int numActors = *(int*)actorFile; 
+  int numActors = readInt<kSwapped>(actorFile); 
   
   /* We hop over numActors get to the start of the actor offsets 
    */ 
@@ -165,7 +235,7 @@ bool imdb::getCredits(const string& player, vector<film>& films) const {
   currPair.playerName = playerPtr; 
    
 
-  void *actorOffsetPtr = bsearch(&currPair, actorsBase, numActors, sizeof(int),nameCmp); 
+  void *actorOffsetPtr = bsearch(&currPair, actorsBase, numActors, sizeof(int),nameCmp<kSwapped>); 
   
   if ( !actorOffsetPtr ) return false; 
  
@@ -189,14 +259,14 @@ bool imdb::getCredits(const string& player, vector<film>& films) const {
     strcpy(tempnameptr, (const char*)actorRecord); 
     string strtemp(tempnameptr); 
   */
-  int currOffset = *(int*)actorOffsetPtr; 
+  int currOffset = readInt<kSwapped>(actorOffsetPtr); 
   void* actorRecord = (char*)actorFile + currOffset*sizeof(char); 
   string strtemp = (char*)actorRecord;
   
 
   void* numMoviesPtr = (char*)actorRecord + nameLen*sizeof(char); 
   
-  unsigned short numMovies = *(short*)numMoviesPtr; 
+  unsigned short numMovies = readShort<kSwapped>(numMoviesPtr); 
     
   int prefixLen = nameLen + 2; 
   if (prefixLen % 4 != 0) 
@@ -208,7 +278,7 @@ bool imdb::getCredits(const string& player, vector<film>& films) const {
   void *creditsBase = (char*)actorRecord + prefixLen*sizeof(char); 
   for (int i = 0; i < numMovies; i++){ 
     void *offsetPtr = (char*)creditsBase + i*sizeof(int); 
-    int movieOffset = *(int*)offsetPtr; 
+    int movieOffset = readInt<kSwapped>(offsetPtr); 
     void *moviePtr = (char*)movieFile + movieOffset*sizeof(char); 
     
     char *titlePtr = strdup((char*)moviePtr); 
@@ -257,6 +327,7 @@ bool imdb::getCredits(const string& player, vector<film>& films) const {
  
 
 
+template <bool kSwapped>
 int imdb::movieCmp(const void *vp1, const void* vp2)
 { 
   MovieSearchPair *sp = (MovieSearchPair*)vp1; 
@@ -266,7 +337,7 @@ int imdb::movieCmp(const void *vp1, const void* vp2)
   const char *keyTitlePtr = keyTitle.c_str(); 
   int keyYear = tempFilm->year; 
 
-  int currOffset = *(int*)vp2; 
+  int currOffset = readInt<kSwapped>(vp2); 
   
   void *currRecordPtr = (char*)referenceFile + currOffset*sizeof(char); 
   int cmpTitleLen = strlen((char*)currRecordPtr)+1; 
@@ -293,7 +364,13 @@ int imdb::movieCmp(const void *vp1, const void* vp2)
  * efficiently search the data file
  */ 
 
-bool imdb::getCast(const film& movie, vector<string>& players) const { 
+bool imdb::getCast(const film& movie, vector<string>& players) const
+{
+  return swapped ? readCast<true>(movie, players) : readCast<false>(movie, players);
+}
+
+template <bool kSwapped>
+bool imdb::readCast(const film& movie, vector<string>& players) const { 
 
   MovieSearchPair currPair; 
   currPair.movieFilePtr = movieFile; 
@@ -301,14 +378,14 @@ bool imdb::getCast(const film& movie, vector<string>& players) const {
   currFilmPtr = &movie; 
   currPair.targetFilm = currFilmPtr; 
   
-  int numMovies = *(int*)movieFile; 
+  int numMovies = readInt<kSwapped>(movieFile); 
   void *startMovieOffsets = (char*)movieFile + 1*sizeof(int); 
   
-  void *movieOffsetPtr = bsearch(&currPair, startMovieOffsets, numMovies, sizeof(int), movieCmp); 
+  void *movieOffsetPtr = bsearch(&currPair, startMovieOffsets, numMovies, sizeof(int), movieCmp<kSwapped>); 
   
   if ( !movieOffsetPtr ) return false; 
   
-  int currOffset = *(int*)movieOffsetPtr; 
+  int currOffset = readInt<kSwapped>(movieOffsetPtr); 
   void *movieRecord = (char*)movieFile + currOffset*sizeof(char); 
 
   /* strlen excludes the terminating \0*/ 
@@ -322,7 +399,7 @@ bool imdb::getCast(const film& movie, vector<string>& players) const {
   if (partialPrefix % 2 != 0) 
     partialPrefix++; 
 
-  unsigned short numCast = *(short*)((char*)movieRecord + partialPrefix*sizeof(char)); 
+  unsigned short numCast = readShort<kSwapped>((char*)movieRecord + partialPrefix*sizeof(char)); 
 
    /* a 2 byte short representing the number of cast members 
    * sits after the partial prefix. If the partial prefix 
@@ -336,7 +413,7 @@ bool imdb::getCast(const film& movie, vector<string>& players) const {
   void *offsetsBase = (char*)movieRecord + fullPrefix*sizeof(char); 
 
   for (int i = 0; i < numCast; i++) { 
-    int numCastOffset = *(int*)((char*)offsetsBase + i*sizeof(int)); 
+    int numCastOffset = readInt<kSwapped>((char*)offsetsBase + i*sizeof(int)); 
     void *currActorRecord = (char*)actorFile + numCastOffset*sizeof(char); 
     string currActor = (char*)currActorRecord; 
     players.push_back(currActor); 
@@ -346,6 +423,183 @@ bool imdb::getCast(const film& movie, vector<string>& players) const {
   
 }
 
+int imdb::getNumActors() const { return swapped ? readInt<true>(actorFile) : readInt<false>(actorFile); }
+int imdb::getNumMovies() const { return swapped ? readInt<true>(movieFile) : readInt<false>(movieFile); }
+
+/** Implementation note: getActorId, getMovieId
+ * --------------------------------------------
+ * Same binary searches as getCredits and getCast, except that we
+ * return the position of the matching offset within the offset table,
+ * which is exactly the dense ID of the record.
+ */
+
+int imdb::getActorId(const string& player) const
+{
+  ActorSearchPair currPair;
+  currPair.actorFilePtr = actorFile;
+  currPair.playerName = player.c_str();
+  const int *actorOffsetPtr = (const int *) bsearch(&currPair, getActorOffsets(), getNumActors(),
+                                                    sizeof(int), swapped ? nameCmp<true> : nameCmp<false>);
+  if (actorOffsetPtr == NULL) return -1;
+  return actorOffsetPtr - getActorOffsets();
+}
+
+int imdb::getMovieId(const film& movie) const
+{
+  MovieSearchPair currPair;
+  currPair.movieFilePtr = movieFile;
+  currPair.targetFilm = &movie;
+  const int *movieOffsetPtr = (const int *) bsearch(&currPair, getMovieOffsets(), getNumMovies(),
+                                                    sizeof(int), swapped ? movieCmp<true> : movieCmp<false>);
+  if (movieOffsetPtr == NULL) return -1;
+  return movieOffsetPtr - getMovieOffsets();
+}
+
+const char *imdb::getActorRecord(int actorId) const
+{
+  const int *offsetPtr = getActorOffsets() + actorId;
+  return (const char *) actorFile + (swapped ? readInt<true>(offsetPtr) : readInt<false>(offsetPtr));
+}
+
+const char *imdb::getMovieRecord(int movieId) const
+{
+  const int *offsetPtr = getMovieOffsets() + movieId;
+  return (const char *) movieFile + (swapped ? readInt<true>(offsetPtr) : readInt<false>(offsetPtr));
+}
+
+const char *imdb::getActorName(int actorId) const
+{
+  return getActorRecord(actorId);
+}
+
+film imdb::getMovie(int movieId) const
+{
+  const char *movieRecord = getMovieRecord(movieId);
+  film movie;
+  movie.title = movieRecord;
+  movie.year = movieRecord[movie.title.size() + 1];
+  return movie;
+}
+
+int imdb::getMovieYear(int movieId) const
+{
+  const char *movieRecord = getMovieRecord(movieId);
+  return movieRecord[strlen(movieRecord) + 1];
+}
+
+/** Implementation note: getActorCreditOffsets, getMovieCastOffsets
+ * ----------------------------------------------------------------
+ * Hop over the name (or title and year) and the two byte count, applying
+ * the same padding rules documented at the top of the file, and return
+ * the address of the array of offsets that follows.  The number of
+ * entries in that array is returned via the reference parameter.
+ */
+
+template <bool kSwapped>
+const int *imdb::getActorCreditOffsets(const char *actorRecord, int& numMovies)
+{
+  int nameLen = strlen(actorRecord) + 1;
+  if (nameLen % 2 != 0) nameLen++;
+  numMovies = readShort<kSwapped>(actorRecord + nameLen);
+  int prefixLen = nameLen + 2;
+  if (prefixLen % 4 != 0) prefixLen += 2;
+  return (const int *)(actorRecord + prefixLen);
+}
+
+template <bool kSwapped>
+const int *imdb::getMovieCastOffsets(const char *movieRecord, int& numActors)
+{
+  int partialPrefix = strlen(movieRecord) + 2;
+  if (partialPrefix % 2 != 0) partialPrefix++;
+  numActors = readShort<kSwapped>(movieRecord + partialPrefix);
+  int fullPrefix = partialPrefix + 2;
+  if (fullPrefix % 4 != 0) fullPrefix += 2;
+  return (const int *)(movieRecord + fullPrefix);
+}
+
+/** Implementation note: offsetToId
+ * --------------------------------
+ * Records refer to one another by byte offset, so turning a credit or
+ * cast entry into an ID means finding that offset within the offset table.
+ * When the table is already in ascending order we binary search it in place,
+ * and otherwise we binary search the permutation built by buildIdsByOffset.
+ */
+
+template <bool kSwapped>
+int imdb::offsetToId(const int *offsets, int count, const vector<int>& idsByOffset, int offset)
+{
+  int low = 0, high = count;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    int id = idsByOffset.empty() ? mid : idsByOffset[mid];
+    if (readInt<kSwapped>(offsets + id) < offset) low = mid + 1;
+    else high = mid;
+  }
+  return idsByOffset.empty() ? low : idsByOffset[low];
+}
+
+template <bool kSwapped>
+struct offsetOrder {
+  const int *offsets;
+  bool operator()(int id1, int id2) const
+  {
+    return readInt<kSwapped>(offsets + id1) < readInt<kSwapped>(offsets + id2);
+  }
+};
+
+template <bool kSwapped>
+void imdb::buildIdsByOffset(const int *offsets, int count, vector<int>& idsByOffset)
+{
+  idsByOffset.clear();
+  bool ascending = true;
+  for (int i = 1; i < count && ascending; i++)
+    ascending = readInt<kSwapped>(offsets + i - 1) < readInt<kSwapped>(offsets + i);
+  if (ascending) return;
+  
+  idsByOffset.resize(count);
+  for (int i = 0; i < count; i++) idsByOffset[i] = i;
+  offsetOrder<kSwapped> order = { offsets };
+  sort(idsByOffset.begin(), idsByOffset.end(), order);
+}
+
+void imdb::getCreditIds(int actorId, vector<int>& movieIds) const
+{
+  if (swapped) readCreditIds<true>(actorId, movieIds);
+  else readCreditIds<false>(actorId, movieIds);
+}
+
+void imdb::getCastIds(int movieId, vector<int>& actorIds) const
+{
+  if (swapped) readCastIds<true>(movieId, actorIds);
+  else readCastIds<false>(movieId, actorIds);
+}
+
+template <bool kSwapped>
+void imdb::readCreditIds(int actorId, vector<int>& movieIds) const
+{
+  int numMovies;
+  const char *actorRecord = getActorRecord(actorId);
+  const int *creditOffsets = getActorCreditOffsets<kSwapped>(actorRecord, numMovies);
+  int totalMovies = readInt<kSwapped>(movieFile);
+  movieIds.resize(numMovies);
+  for (int i = 0; i < numMovies; i++)
+    movieIds[i] = offsetToId<kSwapped>(getMovieOffsets(), totalMovies, movieIdsByOffset,
+                                       readInt<kSwapped>(creditOffsets + i));
+}
+
+template <bool kSwapped>
+void imdb::readCastIds(int movieId, vector<int>& actorIds) const
+{
+  int numActors;
+  const char *movieRecord = getMovieRecord(movieId);
+  const int *castOffsets = getMovieCastOffsets<kSwapped>(movieRecord, numActors);
+  int totalActors = readInt<kSwapped>(actorFile);
+  actorIds.resize(numActors);
+  for (int i = 0; i < numActors; i++)
+    actorIds[i] = offsetToId<kSwapped>(getActorOffsets(), totalActors, actorIdsByOffset,
+                                       readInt<kSwapped>(castOffsets + i));
+}
+
 imdb::~imdb()
 {
   releaseFileMap(actorInfo);
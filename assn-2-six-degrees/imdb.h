@@ -2,6 +2,7 @@
 #define __imdb__
 
 #include "imdb-utils.h"
+#include "imdb-format.h"
 #include <string>
 #include <vector>
 using namespace std;
@@ -34,6 +35,8 @@ class imdb {
    *     1.) either one or both of the data files supporting the imdb were missing
    *     2.) the directory passed to the constructor doesn't exist.
    *     3.) the directory and files all exist, but you don't have the permission to read them.
+   *     4.) the files are in the portable format (see imdb-format.h), but a header
+   *         is malformed, a checksum doesn't match, or the two files disagree on byte order.
    */
 
   bool good() const;
@@ -75,6 +78,58 @@ class imdb {
 
   bool getCast(const film& movie, vector<string>& players) const;
 
+  /**
+   * Methods: getNumActors, getNumMovies
+   * -----------------------------------
+   * Report the number of actor and movie records housed by the imdb.
+   * Every actor and every movie is also identified by a dense integer
+   * ID, which is simply its position within the sorted offset table
+   * at the front of its data file.  Actor IDs are drawn from
+   * [0, getNumActors()) and movie IDs from [0, getNumMovies()), so
+   * clients can index plain arrays by ID instead of hashing names.
+   */
+
+  int getNumActors() const;
+  int getNumMovies() const;
+
+  /**
+   * Methods: getActorId, getMovieId
+   * -------------------------------
+   * Translate a name or film into its dense ID using the same binary
+   * search that getCredits and getCast rely on.
+   *
+   * @return the ID of the actor or movie, or -1 if it isn't in the database.
+   */
+
+  int getActorId(const string& player) const;
+  int getMovieId(const film& movie) const;
+
+  /**
+   * Methods: getActorName, getMovie, getMovieYear
+   * ---------------------------------------------
+   * Translate a dense ID back into the actor's name or the film
+   * record.  The name returned by getActorName points directly into
+   * the memory mapped data file and is valid for the life of the imdb.
+   * getMovieYear is getMovie(movieId).year without building the title.
+   */
+
+  const char *getActorName(int actorId) const;
+  film getMovie(int movieId) const;
+  int getMovieYear(int movieId) const;
+
+  /**
+   * Methods: getCreditIds, getCastIds
+   * ---------------------------------
+   * ID-based versions of getCredits and getCast.  The specified vector
+   * is cleared and then populated with the IDs of the movies the actor
+   * appeared in (or the actors appearing in the movie), in the order
+   * they're stored in the data files.  No strings or films are
+   * constructed, which is what graph searches over the full database want.
+   */
+
+  void getCreditIds(int actorId, vector<int>& movieIds) const;
+  void getCastIds(int movieId, vector<int>& actorIds) const;
+
   /**
    * Destructor: ~imdb
    * -----------------
@@ -101,8 +156,36 @@ class imdb {
   const void *actorFile;
   const void *movieFile;
   
-  static int nameCmp(const void* vp1, const void* vp2); 
-  static int movieCmp(const void* vp1, const void* vp2);
+  // valid is false if a portable data file failed validation.  swapped is true
+  // if the data files are in the opposite byte order from the host, in which
+  // case every read goes through the kSwapped = true instantiations below.
+  bool valid;
+  bool swapped;
+
+  template <bool kSwapped> static int nameCmp(const void* vp1, const void* vp2); 
+  template <bool kSwapped> static int movieCmp(const void* vp1, const void* vp2);
+  template <bool kSwapped> bool readCredits(const string& player, vector<film>& films) const;
+  template <bool kSwapped> bool readCast(const film& movie, vector<string>& players) const;
+
+  // helpers shared by the ID-based methods.  The offset tables are normally
+  // laid out in the same order as the records themselves, in which case
+  // record offsets map back to IDs by binary searching the tables directly.
+  // Otherwise a sorted copy of each table is built once at open time.
+  vector<int> actorIdsByOffset;
+  vector<int> movieIdsByOffset;
+
+  const int *getActorOffsets() const { return (const int *) actorFile + 1; }
+  const int *getMovieOffsets() const { return (const int *) movieFile + 1; }
+  const char *getActorRecord(int actorId) const;
+  const char *getMovieRecord(int movieId) const;
+  template <bool kSwapped> void readCreditIds(int actorId, vector<int>& movieIds) const;
+  template <bool kSwapped> void readCastIds(int movieId, vector<int>& actorIds) const;
+  template <bool kSwapped> static const int *getActorCreditOffsets(const char *actorRecord, int& numMovies);
+  template <bool kSwapped> static const int *getMovieCastOffsets(const char *movieRecord, int& numActors);
+  template <bool kSwapped>
+  static int offsetToId(const int *offsets, int count, const vector<int>& idsByOffset, int offset);
+  template <bool kSwapped>
+  static void buildIdsByOffset(const int *offsets, int count, vector<int>& idsByOffset);
 
   // everything below here is complicated and needn't be touched.
   // you're free to investigate, but you're on your own.
@@ -113,6 +196,7 @@ class imdb {
   } actorInfo, movieInfo;
   
   static const void *acquireFileMap(const string& fileName, struct fileInfo& info);
+  static const void *openSection(const fileInfo& info, int section, bool& swapped);
   static void releaseFileMap(struct fileInfo& info);
 
   // marked as private so imdbs can't be copy constructed or reassigned.
@@ -0,0 +1,94 @@
+#ifndef __radix_heap__
+#define __radix_heap__
+
+#include <vector>
+#include <utility>
+using namespace std;
+
+/**
+ * Class: radixHeap
+ * ----------------
+ * Monotone priority queue of (key, value) pairs with unsigned integer
+ * keys, as used by Dijkstra's algorithm with integer edge weights.
+ * The heap requires that no key smaller than the most recently
+ * popped key is ever pushed, which Dijkstra guarantees.  In exchange,
+ * push is constant time and pop is amortized O(log C), where C is
+ * the largest key, with no comparisons between unrelated entries.
+ *
+ * Entries live in 33 buckets: bucket 0 holds keys equal to the last
+ * popped key, and bucket i holds keys whose highest bit differing from
+ * the last popped key is bit i - 1.  When bucket 0 runs dry, the first
+ * nonempty bucket is redistributed around its minimum, and every entry
+ * moves to a strictly lower bucket.
+ */
+
+class radixHeap {
+
+ public:
+  radixHeap() : last(0), numEntries(0), buckets(kNumBuckets) {}
+
+  bool empty() const { return numEntries == 0; }
+  size_t size() const { return numEntries; }
+
+  /**
+   * Method: push
+   * ------------
+   * Inserts the specified value with the specified key.  The key
+   * must be at least as large as the most recently popped key.
+   */
+
+  void push(unsigned int key, int value)
+  {
+    buckets[bucketFor(key)].push_back(make_pair(key, value));
+    numEntries++;
+  }
+
+  /**
+   * Method: pop
+   * -----------
+   * Removes an entry with the smallest key, returning its key and value
+   * through the reference parameters.  The heap must not be empty.
+   */
+
+  void pop(unsigned int& key, int& value)
+  {
+    if (buckets[0].empty()) redistribute();
+    key = buckets[0].back().first;
+    value = buckets[0].back().second;
+    buckets[0].pop_back();
+    numEntries--;
+  }
+
+  void clear()
+  {
+    for (int i = 0; i < kNumBuckets; i++) buckets[i].clear();
+    last = 0;
+    numEntries = 0;
+  }
+
+ private:
+  static const int kNumBuckets = 33;
+  unsigned int last;
+  size_t numEntries;
+  vector<vector<pair<unsigned int, int> > > buckets;
+
+  int bucketFor(unsigned int key) const
+  {
+    return key == last ? 0 : 32 - __builtin_clz(key ^ last);
+  }
+
+  void redistribute()
+  {
+    int i = 1;
+    while (buckets[i].empty()) i++;
+    vector<pair<unsigned int, int> >& source = buckets[i];
+    last = source[0].first;
+    for (size_t j = 1; j < source.size(); j++)
+      if (source[j].first < last) last = source[j].first;
+    for (size_t j = 0; j < source.size(); j++)
+      buckets[bucketFor(source[j].first)].push_back(source[j]);
+    source.clear();
+  }
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "shortest-paths.h"
+#include <algorithm>
+using namespace std;
+
+/**
+ * pathCounts are stored least significant limb first, with no
+ * leading zero limbs, so zero is the empty vector.
+ */
+
+pathCount::pathCount(unsigned int value)
+{
+  if (value != 0) limbs.push_back(value);
+}
+
+pathCount& pathCount::operator+=(const pathCount& rhs)
+{
+  if (rhs.limbs.size() > limbs.size()) limbs.resize(rhs.limbs.size(), 0);
+  unsigned long long carry = 0;
+  for (size_t i = 0; i < limbs.size(); i++) {
+    if (i >= rhs.limbs.size() && carry == 0) break;
+    unsigned long long sum = carry + limbs[i] + (i < rhs.limbs.size() ? rhs.limbs[i] : 0);
+    limbs[i] = (unsigned int) sum;
+    carry = sum >> 32;
+  }
+  if (carry != 0) limbs.push_back((unsigned int) carry);
+  return *this;
+}
+
+/**
+ * Repeatedly divides a scratch copy by 10^9, collecting nine decimal
+ * digits at a time.  Quadratic in the number of limbs, but we only
+ * print a handful of counts.
+ */
+
+string pathCount::toString() const
+{
+  if (limbs.empty()) return "0";
+  vector<unsigned int> quotient = limbs;
+  vector<unsigned int> chunks;
+  while (!quotient.empty()) {
+    unsigned long long remainder = 0;
+    for (int i = quotient.size() - 1; i >= 0; i--) {
+      unsigned long long current = (remainder << 32) | quotient[i];
+      quotient[i] = (unsigned int) (current / 1000000000);
+      remainder = current % 1000000000;
+    }
+    while (!quotient.empty() && quotient.back() == 0) quotient.pop_back();
+    chunks.push_back((unsigned int) remainder);
+  }
+
+  string digits = to_string(chunks.back());
+  for (int i = chunks.size() - 2; i >= 0; i--) {
+    string chunk = to_string(chunks[i]);
+    digits += string(9 - chunk.size(), '0') + chunk;
+  }
+  return digits;
+}
+
+/** Implementation note: shortestPaths
+ * -----------------------------------
+ * Standard level-synchronous BFS over the bipartite actor/movie graph.
+ * Every movie is expanded at most once and every actor is expanded at
+ * most once, exactly like the exploredFilms and exploredCostars sets in
+ * generateShortestPath, but instead of discarding the second and later
+ * ways of reaching an actor on the same level we add their path counts
+ * in.  An actor's count is final by the time its level is expanded,
+ * because all of its predecessors live on the previous level.
+ */
+
+shortestPaths::shortestPaths(const imdb& db, const string& source, const string& target) :
+  db(db), sourceId(db.getActorId(source)), targetId(db.getActorId(target)),
+  actorLevel(db.getNumActors(), -1), movieLevel(db.getNumMovies(), -1),
+  actorSlot(db.getNumActors(), -1), movieSlot(db.getNumMovies(), -1)
+{
+  if (sourceId == -1 || targetId == -1) return;
+
+  actorLevel[sourceId] = 0;
+  actorSlot[sourceId] = counts.size();
+  counts.push_back(pathCount(1));
+
+  vector<int> frontier(1, sourceId);
+  vector<int> movies, nextFrontier, credits, cast;
+  for (int level = 0; !frontier.empty() && actorLevel[targetId] == -1; level++) {
+    movies.clear();
+    for (int i = 0; i < (int) frontier.size(); i++) {
+      int actorId = frontier[i];
+      db.getCreditIds(actorId, credits);
+      for (int j = 0; j < (int) credits.size(); j++) {
+        int movieId = credits[j];
+        if (movieLevel[movieId] == -1) {
+          movieLevel[movieId] = level;
+          movieSlot[movieId] = counts.size();
+          counts.push_back(pathCount());
+          movies.push_back(movieId);
+        }
+        if (movieLevel[movieId] == level)
+          counts[movieSlot[movieId]] += counts[actorSlot[actorId]];
+      }
+    }
+
+    nextFrontier.clear();
+    for (int i = 0; i < (int) movies.size(); i++) {
+      int movieId = movies[i];
+      db.getCastIds(movieId, cast);
+      for (int j = 0; j < (int) cast.size(); j++) {
+        int actorId = cast[j];
+        if (actorLevel[actorId] == -1) {
+          actorLevel[actorId] = level + 1;
+          actorSlot[actorId] = counts.size();
+          counts.push_back(pathCount());
+          nextFrontier.push_back(actorId);
+        }
+        if (actorLevel[actorId] == level + 1)
+          counts[actorSlot[actorId]] += counts[movieSlot[movieId]];
+      }
+    }
+    frontier.swap(nextFrontier);
+  }
+}
+
+const pathCount& shortestPaths::getNumPaths() const
+{
+  static const pathCount kNoPaths;
+  if (!connected()) return kNoPaths;
+  return counts[actorSlot[targetId]];
+}
+
+int shortestPaths::enumerate(int limit, vector<path>& paths) const
+{
+  if (!connected() || limit <= 0) return 0;
+  size_t before = paths.size();
+  vector<int> reversed(1, targetId);
+  enumerateFrom(targetId, reversed, before + limit, paths);
+  return paths.size() - before;
+}
+
+/** Implementation note: enumerateFrom
+ * -----------------------------------
+ * reversed holds target, movie, actor, movie, ..., actorId.  Any movie one
+ * level below actorId that it appeared in, and any actor one level below that
+ * movie, is a legitimate predecessor, so the recursion never dead ends and
+ * never needs to backtrack out of a fruitless branch.  Recursion depth is
+ * bounded by the path length.
+ */
+
+void shortestPaths::enumerateFrom(int actorId, vector<int>& reversed, int limit,
+                                  vector<path>& paths) const
+{
+  if ((int) paths.size() >= limit) return;
+  if (actorId == sourceId) {
+    path found(db.getActorName(sourceId));
+    for (int i = reversed.size() - 3; i >= 0; i -= 2)
+      found.addConnection(db.getMovie(reversed[i + 1]), db.getActorName(reversed[i]));
+    paths.push_back(found);
+    return;
+  }
+
+  int level = actorLevel[actorId];
+  vector<int> credits, cast;
+  db.getCreditIds(actorId, credits);
+  for (int i = 0; i < (int) credits.size() && (int) paths.size() < limit; i++) {
+    int movieId = credits[i];
+    if (movieLevel[movieId] != level - 1) continue;
+    db.getCastIds(movieId, cast);
+    for (int j = 0; j < (int) cast.size() && (int) paths.size() < limit; j++) {
+      int costarId = cast[j];
+      if (actorLevel[costarId] != level - 1) continue;
+      reversed.push_back(movieId);
+      reversed.push_back(costarId);
+      enumerateFrom(costarId, reversed, limit, paths);
+      reversed.pop_back();
+      reversed.pop_back();
+    }
+  }
+}
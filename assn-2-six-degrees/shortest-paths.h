@@ -0,0 +1,131 @@
+#ifndef __shortest_paths__
+#define __shortest_paths__
+
+#include "imdb.h"
+#include "path.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * Convenience Class: pathCount
+ * ----------------------------
+ * Unsigned integer of unbounded size, supporting just enough arithmetic
+ * (addition and printing) to count shortest paths.  The number of
+ * shortest paths between two well connected actors easily overflows
+ * 64 bits, so the count is stored as a little-endian sequence of
+ * 32-bit limbs.
+ */
+
+class pathCount {
+
+ public:
+  pathCount(unsigned int value = 0);
+
+  pathCount& operator+=(const pathCount& rhs);
+  bool isZero() const { return limbs.empty(); }
+  string toString() const;
+
+ private:
+  vector<unsigned int> limbs;
+};
+
+/**
+ * Class: shortestPaths
+ * --------------------
+ * Captures every shortest path between two actors as a breadth
+ * first search level DAG over the dense actor and movie IDs
+ * exposed by the imdb.  Actors and movies each record the BFS
+ * level at which they were discovered and the number of distinct
+ * shortest paths from the source that reach them, so counting
+ * all shortest paths costs time linear in the explored part of the
+ * graph, no matter how many paths there are.  Individual paths are
+ * only materialized (as path objects) when enumerated.
+ *
+ * Two paths are distinct if they differ in any actor or any movie,
+ * so two actors who appeared together in several films are connected
+ * by several distinct paths of length 1.
+ */
+
+class shortestPaths {
+
+ public:
+
+  /**
+   * Constructor: shortestPaths
+   * --------------------------
+   * Runs the breadth first search from source to target, one
+   * actor level at a time, and stops as soon as the level housing
+   * the target has been completed.
+   *
+   * @param db the imdb being searched.  It must outlive the shortestPaths.
+   * @param source the name of the actor or actress the paths start from.
+   * @param target the name of the actor or actress the paths end at.
+   */
+
+  shortestPaths(const imdb& db, const string& source, const string& target);
+
+  /**
+   * Predicate Method: connected
+   * ---------------------------
+   * Returns true if and only if at least one path connects the
+   * source and the target.
+   */
+
+  bool connected() const { return targetId != -1 && actorLevel[targetId] != -1; }
+
+  /**
+   * Method: getLength
+   * -----------------
+   * Returns the number of movies on each shortest path, or -1 if
+   * the two players aren't connected.
+   */
+
+  int getLength() const { return connected() ? actorLevel[targetId] : -1; }
+
+  /**
+   * Method: getNumPaths
+   * -------------------
+   * Returns the number of distinct shortest paths from source to target.
+   */
+
+  const pathCount& getNumPaths() const;
+
+  /**
+   * Method: enumerate
+   * -----------------
+   * Walks the level DAG backwards from the target and appends up to
+   * limit distinct shortest paths to the specified vector.  Each path is
+   * produced in time proportional to its length and the credits of the
+   * players along it, since every step backward through the DAG is
+   * guaranteed to lead back to the source.
+   *
+   * @param limit the maximum number of paths to produce.
+   * @param paths the vector the paths are appended to.
+   * @return the number of paths appended.
+   */
+
+  int enumerate(int limit, vector<path>& paths) const;
+
+ private:
+  const imdb& db;
+  int sourceId;
+  int targetId;
+
+  // levels are -1 for undiscovered actors and movies.  A movie's level is
+  // the level of the actors it was reached from, and countSlot maps each
+  // discovered actor or movie to its entry in the compact counts vector.
+  vector<int> actorLevel;
+  vector<int> movieLevel;
+  vector<int> actorSlot;
+  vector<int> movieSlot;
+  vector<pathCount> counts;
+
+  void enumerateFrom(int actorId, vector<int>& reversed, int limit, vector<path>& paths) const;
+
+  // copying would alias the imdb reference and is never needed
+  shortestPaths(const shortestPaths& original);
+  shortestPaths& operator=(const shortestPaths& rhs);
+};
+
+#endif
@@ -4,131 +4,226 @@
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <climits>
 #include "imdb.h"
 #include "path.h"
-#include <queue> 
+#include "shortest-paths.h"
+#include "weighted-paths.h"
+#include "graph-search.h"
 using namespace std;
 
 /**
  * Using the specified prompt, requests that the user supply
- * the name of an actor or actress.  The code returns
- * once the user has supplied a name for which some record within
- * the referenced imdb existsif (or if the user just hits return,
+ * the name of an actor or actress, or a movie written as its title
+ * followed by its year in parentheses (as in: Title (93)).  The code
+ * returns once the user has supplied a name for which some record within
+ * the referenced imdb exists (or if the user just hits return,
  * which is a signal that the empty string should just be returned.)
  *
  * @param prompt the text that should be used for the meaningful
  *               part of the user prompt.
  * @param db a reference to the imdb which can be used to confirm
  *           that a user's response is a legitimate one.
- * @return the name of the user-supplied actor or actress, or the
+ * @param node updated to identify the actor or movie the user named.
+ * @return the user-supplied name of the actor, actress or movie, or the
  *         empty string.
  */
 
-static string promptForActor(const string& prompt, const imdb& db)
+static string promptForEndpoint(const string& prompt, const imdb& db, graphNode& node)
 {
   string response;
   while (true) {
     cout << prompt << " [or <enter> to quit]: ";
     getline(cin, response);
     if (response == "") return "";
-    vector<film> credits;
-    if (db.getCredits(response, credits)) return response;
+
+    size_t open = response.rfind(" (");
+    if (open != string::npos && response[response.size() - 1] == ')' &&
+        response.find_first_not_of("-0123456789", open + 2) == response.size() - 1) {
+      film movie;
+      movie.title = response.substr(0, open);
+      movie.year = atoi(response.c_str() + open + 2);
+      node = graphNode(true, db.getMovieId(movie));
+      if (node.id != -1) return response;
+    }
+    node = graphNode(false, db.getActorId(response));
+    if (node.id != -1) return response;
     cout << "We couldn't find \"" << response << "\" in the movie database. "
 	 << "Please try again." << endl;
   }
 }
 
+/**
+ * Prints the specified alternating sequence of actors and movies, which
+ * is assumed to include at least one actor.  The actor-to-actor stretch
+ * is printed by the path class, and a movie at either end gets a line of
+ * its own.
+ */
+
+static void printConnection(const imdb& db, const vector<graphNode>& nodes)
+{
+  int first = nodes.front().isMovie ? 1 : 0;
+  int last = nodes.back().isMovie ? nodes.size() - 2 : nodes.size() - 1;
+  if (nodes.front().isMovie) {
+    film movie = db.getMovie(nodes.front().id);
+    cout << "\t\"" << movie.title << "\" (" << movie.year << ") starred "
+         << db.getActorName(nodes[first].id) << "." << endl;
+  }
+  if (first < last) {
+    path connection(db.getActorName(nodes[first].id));
+    for (int i = first + 2; i <= last; i += 2)
+      connection.addConnection(db.getMovie(nodes[i - 1].id), db.getActorName(nodes[i].id));
+    cout << connection;
+  }
+  if (nodes.back().isMovie) {
+    film movie = db.getMovie(nodes.back().id);
+    cout << "\t" << db.getActorName(nodes[last].id) << " was in \"" << movie.title
+         << "\" (" << movie.year << ")." << endl;
+  }
+}
+
 /** Implementation note: generateShortestPath
  * ------------------------------------------
- * generateShortestPath uses the standard breadth first search algorithm to 
- * find the shortest path between two actors (actors are represented by strings
+ * generateShortestPath finds the shortest path between two actors, two
+ * movies, or an actor and a movie, using the bidirectional breadth first
+ * search over dense actor and movie IDs implemented by findShortestPath.
  */ 
 
-bool generateShortestPath(imdb &db, const string& source, const string& target, void* goalPath)
+bool generateShortestPath(const imdb& db, const graphNode& source, const graphNode& target)
 {
-  set<film> exploredFilms; 
-  set<string> exploredCostars; 
-  queue<path> frontier;  
-
-  path initialPath(source); 
-  frontier.push(initialPath); 
-     
-  while ( !frontier.empty() ) {
-
-    path nextPath = frontier.front(); 
-    frontier.pop(); 
-    string costar1 = nextPath.getLastPlayer(); 
-    if ( costar1 == target ){
-      cout << nextPath << endl; 
-      return true;
-    }
-    
-    vector<film> nextCredits; 
-    db.getCredits(costar1, nextCredits); 
-    for(int i = 0; i < (int)nextCredits.size(); i++) { 
-      film currFilm = nextCredits[i];
-
-      if ( exploredFilms.find(currFilm) == exploredFilms.end() ) { 
-	exploredFilms.insert(currFilm); 
-	vector<string> currCast; 
-	db.getCast(currFilm,currCast); 
-	for (int j = 0; j < (int)currCast.size(); j++) { 
-	  const string costar2 = currCast[j];
-	  
-
-	  if( exploredCostars.find(costar2) == exploredCostars.end() ){ 
-	    exploredCostars.insert(costar2); 
-	    path clonePath = nextPath; 
-	    clonePath.addConnection(currFilm, costar2); 
-	    frontier.push(clonePath); 
-	  }
-	}
-      }
-    }
-  }
-  return false; 
+  vector<graphNode> nodes;
+  if (!findShortestPath(db, source, target, nodes)) return false;
+  printConnection(db, nodes);
+  cout << endl;
+  return true;
 }
 
+/** Implementation note: listShortestPaths
+ * ---------------------------------------
+ * Backs the --all-paths mode.  Rather than stopping at the first path
+ * the way generateShortestPath does, we count every shortest path between
+ * the two players and then print at most maxPaths of them.
+ */
+
+static bool listShortestPaths(const imdb& db, const string& source, const string& target, int maxPaths)
+{
+  shortestPaths dag(db, source, target);
+  if (!dag.connected()) return false;
+
+  cout << endl << dag.getNumPaths().toString() << " distinct shortest path(s) of length "
+       << dag.getLength() << " connect " << source << " and " << target << "." << endl;
+  vector<path> paths;
+  dag.enumerate(maxPaths, paths);
+  for (int i = 0; i < (int) paths.size(); i++)
+    cout << paths[i] << endl;
+  return true;
+}
+
+/** Implementation note: printWeightedPath
+ * ---------------------------------------
+ * Backs the --weighted mode.  The lightest path is printed in the same
+ * format generateShortestPath uses, followed by its total weight.
+ */
+
+static bool printWeightedPath(const imdb& db, const movieWeights& weights,
+                              const string& source, const string& target)
+{
+  path lightest(source);
+  unsigned int totalWeight;
+  if (!generateWeightedPath(db, weights, source, target, lightest, totalWeight)) return false;
+  cout << lightest << "\t(total weight " << totalWeight << ")" << endl << endl;
+  return true;
+}
 
 /**
  * Serves as the main entry point for the six-degrees executable.
  * There are no parameters to speak of.
  *
+ * Usage: six-degrees [--all-paths <max-paths> | --weighted uniform|cast|age] [<data-directory>]
+ *
  * @param argc the number of tokens passed to the command line to
- *             invoke this executable.  It's completely ignored
- *             here, because we don't expect any arguments.
+ *             invoke this executable.
  * @param argv the C strings making up the full command line.
  *             We expect argv[0] to be logically equivalent to
  *             "six-degrees" (or whatever absolute path was used to
- *             invoke the program), but otherwise these are ignored
- *             as well.
+ *             invoke the program).  --all-paths asks for the number of
+ *             shortest paths along with up to <max-paths> (at least 1) of
+ *             them, --weighted asks for the lightest path under the named
+ *             movie weighting (the two can't be combined), and an optional
+ *             trailing argument names the data directory.
  * @return 0 if the program ends normally, and undefined otherwise.
  */
 
+static const char *const kUsage =
+  "Usage: six-degrees [--all-paths <max-paths> | --weighted uniform|cast|age] [<data-directory>]";
+
 int main(int argc, const char *argv[])
 {
+  int maxPaths = 0;
+  const char *weightingName = NULL;
+  const char *dataDirectory = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--all-paths") == 0 && i + 1 < argc) {
+      char *end;
+      long requested = strtol(argv[++i], &end, 10);
+      if (*end != '\0' || requested < 1 || requested > INT_MAX) {
+        cerr << kUsage << endl;
+        return 1;
+      }
+      maxPaths = requested;
+    } else if (strcmp(argv[i], "--weighted") == 0 && i + 1 < argc) {
+      weightingName = argv[++i];
+    } else if (argv[i][0] != '-') {
+      dataDirectory = argv[i];
+    } else {
+      cerr << kUsage << endl;
+      return 1;
+    }
+  }
+  if (maxPaths > 0 && weightingName != NULL) {
+    cerr << kUsage << endl;
+    return 1;
+  }
 
-  imdb db(determinePathToData("/home/compilers/cs107/assn-2-six-degrees-data/little-endian/")); // inlined in imdb-utils.h
+  movieWeights::weighting weighting = movieWeights::kUniformWeights;
+  if (weightingName != NULL) {
+    if (strcmp(weightingName, "cast") == 0) weighting = movieWeights::kCastSizeWeights;
+    else if (strcmp(weightingName, "age") == 0) weighting = movieWeights::kAgeWeights;
+    else if (strcmp(weightingName, "uniform") != 0) {
+      cerr << "Unknown weighting \"" << weightingName << "\".  Choose uniform, cast, or age." << endl;
+      return 1;
+    }
+  }
+
+  imdb db(determinePathToData(dataDirectory)); // inlined in imdb-utils.h
   if (!db.good()) {
     cout << "Failed to properly initialize the imdb database." << endl;
     cout << "Please check to make sure the source files exist and that you have permission to read them." << endl;
     exit(1);
   }
-  
+
+  movieWeights *weights = weightingName != NULL ? new movieWeights(db, weighting) : NULL;
   while (true) {
-    string source = promptForActor("Actor or actress", db);
+    graphNode sourceNode, targetNode;
+    string source = promptForEndpoint("Actor, actress or movie", db, sourceNode);
     if (source == "") break;
-    string target = promptForActor("Another actor or actress", db);
+    string target = promptForEndpoint("Another actor, actress or movie", db, targetNode);
     if (target == "") break;
-    if (source == target) {
-      cout << "Good one.  This is only interesting if you specify two different people." << endl;
+    if (sourceNode == targetNode) {
+      cout << "Good one.  This is only interesting if you specify two different endpoints." << endl;
+    } else if ((maxPaths > 0 || weightingName != NULL) && (sourceNode.isMovie || targetNode.isMovie)) {
+      cout << "--all-paths and --weighted only connect actors and actresses." << endl;
     } else {
-      // replace the following line by a call to your generateShortestPath routine... 
-      path *goalPtr; 
-      bool foundSolution = generateShortestPath(db, source, target, &goalPtr); 
+      bool foundSolution;
+      if (maxPaths > 0)
+        foundSolution = listShortestPaths(db, source, target, maxPaths);
+      else if (weightingName != NULL)
+        foundSolution = printWeightedPath(db, *weights, source, target);
+      else
+        foundSolution = generateShortestPath(db, sourceNode, targetNode); 
       
       if ( !foundSolution )  
-	cout << endl << "No path between those two people could be found." << endl << endl;
+	cout << endl << "No path between those two could be found." << endl << endl;
       else { 
 	cout << "found " << endl;  
       }
@@ -136,6 +231,7 @@ int main(int argc, const char *argv[])
     }
   }
   
+  delete weights;
   cout << "Thanks for playing!" << endl;
   return 0;
 }
@@ -0,0 +1,84 @@
+#include "weighted-paths.h"
+#include "radix-heap.h"
+#include <vector>
+using namespace std;
+
+movieWeights::movieWeights(const imdb& db, weighting kind) : db(db), kind(kind), newestYear(0)
+{
+  if (kind != kAgeWeights) return;
+  for (int movieId = 0; movieId < db.getNumMovies(); movieId++) {
+    int year = db.getMovieYear(movieId);
+    if (year > newestYear) newestYear = year;
+  }
+}
+
+unsigned int movieWeights::getWeight(int movieId, int castSize) const
+{
+  switch (kind) {
+    case kCastSizeWeights: return castSize > 2 ? castSize - 1 : 1;
+    case kAgeWeights: return 1 + (newestYear - db.getMovieYear(movieId));
+    default: return 1;
+  }
+}
+
+/** Implementation note: generateWeightedPath
+ * ------------------------------------------
+ * parentMovie and parentActor record the movie and costar each actor's
+ * best known distance came through, so the path is rebuilt backwards from
+ * the target once it is popped.  Stale heap entries (those whose key
+ * exceeds the actor's current distance) are simply skipped.
+ */
+
+bool generateWeightedPath(const imdb& db, const movieWeights& weights,
+                          const string& source, const string& target,
+                          path& result, unsigned int& totalWeight)
+{
+  int sourceId = db.getActorId(source);
+  int targetId = db.getActorId(target);
+  if (sourceId == -1 || targetId == -1) return false;
+
+  const unsigned int kUnreached = ~0u;
+  vector<unsigned int> distance(db.getNumActors(), kUnreached);
+  vector<int> parentMovie(db.getNumActors(), -1);
+  vector<int> parentActor(db.getNumActors(), -1);
+  vector<bool> exploredFilms(db.getNumMovies(), false);
+  vector<int> credits, cast;
+  radixHeap frontier;
+
+  distance[sourceId] = 0;
+  frontier.push(0, sourceId);
+  while (!frontier.empty()) {
+    unsigned int currDistance;
+    int actorId;
+    frontier.pop(currDistance, actorId);
+    if (currDistance != distance[actorId]) continue;
+    if (actorId == targetId) break;
+
+    db.getCreditIds(actorId, credits);
+    for (int i = 0; i < (int) credits.size(); i++) {
+      int movieId = credits[i];
+      if (exploredFilms[movieId]) continue;
+      exploredFilms[movieId] = true;
+      db.getCastIds(movieId, cast);
+      unsigned int nextDistance = currDistance + weights.getWeight(movieId, cast.size());
+      for (int j = 0; j < (int) cast.size(); j++) {
+        int costarId = cast[j];
+        if (nextDistance >= distance[costarId]) continue;
+        distance[costarId] = nextDistance;
+        parentMovie[costarId] = movieId;
+        parentActor[costarId] = actorId;
+        frontier.push(nextDistance, costarId);
+      }
+    }
+  }
+
+  if (distance[targetId] == kUnreached) return false;
+
+  path reversed(target);
+  for (int actorId = targetId; actorId != sourceId; actorId = parentActor[actorId])
+    reversed.addConnection(db.getMovie(parentMovie[actorId]), db.getActorName(parentActor[actorId]));
+  reversed.reverse();
+  result = reversed;
+  totalWeight = distance[targetId];
+  return true;
+}
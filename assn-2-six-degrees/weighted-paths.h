@@ -0,0 +1,70 @@
+#ifndef __weighted_paths__
+#define __weighted_paths__
+
+#include "imdb.h"
+#include "path.h"
+#include <string>
+using namespace std;
+
+/**
+ * Class: movieWeights
+ * -------------------
+ * Assigns every movie a positive integer weight that measures how weak
+ * a link the movie is between two members of its cast.  Lower weights
+ * are stronger links, so the lightest path between two actors is the
+ * one that passes through the most "meaningful" films.
+ *
+ *    kUniformWeights: every movie weighs 1, which reproduces BFS.
+ *    kCastSizeWeights: a movie weighs one less than the size of its cast,
+ *                      so sprawling ensemble films are weak links and a
+ *                      two-hander is as strong as it gets.
+ *    kAgeWeights: a movie weighs one more than the number of years between
+ *                 it and the newest movie in the database.
+ */
+
+class movieWeights {
+
+ public:
+  enum weighting { kUniformWeights, kCastSizeWeights, kAgeWeights };
+
+  movieWeights(const imdb& db, weighting kind);
+
+  /**
+   * Method: getWeight
+   * -----------------
+   * Returns the weight of the specified movie.  The cast size is
+   * passed in because the search has just read the cast anyway.
+   */
+
+  unsigned int getWeight(int movieId, int castSize) const;
+
+ private:
+  const imdb& db;
+  weighting kind;
+  int newestYear;
+};
+
+/**
+ * Function: generateWeightedPath
+ * ------------------------------
+ * Dijkstra's algorithm over the dense actor IDs, using a radix heap keyed
+ * on integer path weight.  Like generateShortestPath, each movie is expanded
+ * at most once: the first actor settled from any movie has the smallest
+ * distance in its cast, so relaxing the rest of the cast from anyone else
+ * can never help.  Beyond the BFS cost, all that's added is a constant time
+ * push per improved actor and amortized logarithmic pops.
+ *
+ * @param db the imdb being searched.
+ * @param weights the weight assigned to each movie.
+ * @param source the actor or actress the path starts from.
+ * @param target the actor or actress the path ends at.
+ * @param result updated to hold the lightest path, if there is one.
+ * @param totalWeight updated to hold the sum of the movie weights along result.
+ * @return true if and only if some path connects source and target.
+ */
+
+bool generateWeightedPath(const imdb& db, const movieWeights& weights,
+                          const string& source, const string& target,
+                          path& result, unsigned int& totalWeight);
+
+#endif